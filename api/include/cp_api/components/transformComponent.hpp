@@ -2,77 +2,124 @@
 
 #include "cp_api/core/math.hpp"
 #include "cp_api/physics/aabb.hpp"
-#include "cp_api/core/events.hpp"
-#include <functional>
+#include "cp_api/world/transformStore.hpp"
+
+#include <entt/entt.hpp>
 
 namespace cp_api {
     class World;
-    struct onTransformChanged : Event {
-        uint32_t id; 
-        Vec3 oldPos;
-        Quat oldRot;
-        Vec3 oldScale;
-        Vec3 newPos;
-        Quat newRot;
-        Vec3 newScale;
-        physics3D::AABB oldBoundary;
-        physics3D::AABB newBoundary;
-    };
 
+    /**
+     * @brief Handle to an entity's position, rotation, scale and world-space bounds.
+     *
+     * The data itself lives in the World's TransformStore (SoA, 8 transforms per SIMD block);
+     * the component only keeps its slot. Until the World attaches it (on emplace), the values
+     * passed to the constructor are kept locally.
+     *
+     * Changing the transform only marks it dirty; World::SyncTransforms() recomputes matrices
+     * and bounds of every dirty transform once per frame and updates the world SpatialTree3D in
+     * one batch. Until the next sync, GetBounds() and the matrices still hold the previous values.
+     * Outside a World, use ComputeWorldBounds() / ComputeWorldMatrix().
+     *
+     * The parent is referenced by entity (not by pointer): EnTT moves components around when
+     * others are removed, and a destroyed parent simply stops resolving (the child becomes a root).
+     */
     struct TransformComponent {
         friend class World;
         TransformComponent(const Vec3& position,
                            const Quat& rotation,
                            const Vec3& scale,
                            const physics3D::AABB& boundary) noexcept
-            : position(position), rotation(rotation), scale(scale) {
-                this->boundary = physics3D::AABB(position + boundary.min, position + boundary.max, boundary.userData);
-            }
+            : m_pending{ position, rotation, scale, boundary } {}
 
-        Vec3 position;
-        Quat rotation;
-        Vec3 scale;
-        TransformComponent* parent = nullptr;
+        Vec3 GetPosition() const { return m_store ? m_store->GetPosition(m_slot) : m_pending.position; }
+        Quat GetRotation() const { return m_store ? m_store->GetRotation(m_slot) : m_pending.rotation; }
+        Vec3 GetScale() const { return m_store ? m_store->GetScale(m_slot) : m_pending.scale; }
 
-        physics3D::AABB boundary;
+        void SetPosition(const Vec3& value) {
+            if (m_store) m_store->SetPosition(m_slot, value);
+            else m_pending.position = value;
+        }
+        void SetRotation(const Quat& value) {
+            if (m_store) m_store->SetRotation(m_slot, value);
+            else m_pending.rotation = value;
+        }
+        void SetScale(const Vec3& value) {
+            if (m_store) m_store->SetScale(m_slot, value);
+            else m_pending.scale = value;
+        }
 
         void Translate(Vec3 direction, float amount) {
-            onTransformChanged otc{};
-            otc.id = m_entityID;
-            otc.oldPos = position;
-            otc.oldRot = rotation;
-            otc.oldScale = scale;
-            otc.oldBoundary = boundary;
-
-            position += direction * amount;
-            boundary.min += direction * amount;
-            boundary.max += direction * amount;
-
-            otc.newPos = position;
-            otc.newRot = rotation;
-            otc.newScale = scale;
-            otc.newBoundary = boundary;
-            
-            onTransformEvents.Emit<onTransformChanged>(otc);
+            SetPosition(GetPosition() + direction * amount);
         }
 
-        Mat4 GetModelMatrix() const {
-            Mat4 model{1.0f};
+        /// Bounds locais (relativas à posição), as passadas no construtor.
+        void SetLocalBounds(const physics3D::AABB& bounds) {
+            if (m_store) m_store->SetLocalBounds(m_slot, bounds);
+            else m_pending.localBounds = bounds;
+        }
+        physics3D::AABB GetLocalBounds() const { return m_store ? m_store->GetLocalBounds(m_slot) : m_pending.localBounds; }
+
+        /// Bounds de mundo que a árvore do World conhece (atualizadas no SyncTransforms).
+        physics3D::AABB GetBounds() const { return m_store ? m_store->GetWorldBounds(m_slot) : ComputeWorldBounds(); }
+
+        /// Entidade pai (com TransformComponent no mesmo registry), ou entt::null.
+        void SetParent(entt::entity parent) {
+            m_parent = parent;
+            if (m_store) m_store->MarkHierarchyChanged();
+        }
+        entt::entity GetParent() const { return m_parent; }
 
-            model = glm::translate(model, position);
-            model = glm::mat4_cast(rotation) * model;
-            model = glm::scale(model, scale);
+        void MarkDirty() { if (m_store) m_store->MarkDirty(m_slot); }
+        bool IsDirty() const { return m_store && m_store->IsDirty(m_slot); }
+
+        /// AABB das bounds locais depois de escala, rotação e translação (escalar, sem cache).
+        physics3D::AABB ComputeWorldBounds() const {
+            const physics3D::AABB local = GetLocalBounds();
+            const Vec3 scale = GetScale();
+            const Vec3 center = local.Center() * scale;
+            const Vec3 extents = local.Extents() * glm::abs(scale);
+
+            const Mat3 r = glm::mat3_cast(GetRotation());
+            const Mat3 absR(glm::abs(r[0]), glm::abs(r[1]), glm::abs(r[2]));
+
+            const Vec3 worldCenter = GetPosition() + r * center;
+            const Vec3 worldExtents = absR * extents;
+            return physics3D::AABB(worldCenter - worldExtents, worldCenter + worldExtents);
+        }
+
+        /// T * R * S, o mesmo que o kernel do TransformStore calcula.
+        Mat4 GetModelMatrix() const {
+            Mat4 model = glm::translate(Mat4{1.0f}, GetPosition());
+            model = model * glm::mat4_cast(GetRotation());
+            model = glm::scale(model, GetScale());
 
             return model;
         }
 
-        Mat4 GetWorldMatrix() const {
-            if (parent)
-                return parent->GetWorldMatrix() * GetModelMatrix();
+        /// Matrizes em cache, válidas a partir do último World::SyncTransforms.
+        Mat4 GetLocalMatrix() const { return m_store ? m_store->GetLocalMatrix(m_slot) : GetModelMatrix(); }
+        Mat4 GetWorldMatrix() const { return m_store ? m_store->GetWorldMatrix(m_slot) : GetModelMatrix(); }
+
+        /// Recalcula subindo pelos pais em `registry` (sem cache).
+        Mat4 ComputeWorldMatrix(const entt::registry& registry) const {
+            if (const TransformComponent* parent = m_parent != entt::null ? registry.try_get<TransformComponent>(m_parent) : nullptr)
+                return parent->ComputeWorldMatrix(registry) * GetModelMatrix();
             return GetModelMatrix();
         }
+
+        uint32_t GetSlot() const { return m_slot; }
     private:
-        uint32_t m_entityID;
-        EventDispatcher onTransformEvents;
+        struct Pending {
+            Vec3 position;
+            Quat rotation;
+            Vec3 scale;
+            physics3D::AABB localBounds;
+        };
+
+        TransformStore* m_store = nullptr;
+        uint32_t m_slot = TransformStore::InvalidSlot;
+        entt::entity m_parent = entt::null;
+        Pending m_pending; // valores até o World anexar
     };
 } // namespace cp_api
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <nlohmann/json.hpp>
 #include <optional>
+#include <memory_resource>
 
 namespace cp_api {
     /**
@@ -34,6 +35,7 @@ namespace cp_api {
             AABBT bounds;
             int depth{0};
             bool subdivided{false};
+            uint32_t userIndex{UINT32_MAX}; // livre para o dono da árvore (ex.: blocos SoA do TerrainCollider)
             std::vector<Entry> items;
             std::unique_ptr<Node> children[ChildCount]{nullptr};
         };
@@ -58,6 +60,13 @@ namespace cp_api {
          */
         void Insert(uint32_t id,const AABBT& bounds, void* userData, uint32_t layer = 0xFFFFFFFF);
 
+        /**
+         * @brief Replace the tree contents with a batch of entries, built top-down in one pass.
+         * Cheaper than repeated Insert() for large static sets (no redistribution on every split).
+         * @param entries Entries to load; consumed.
+         */
+        void BulkLoad(std::vector<Entry>&& entries);
+
         /**
          * @brief Remove an object by ID and bounds.
          * @param id Object ID.
@@ -95,6 +104,9 @@ namespace cp_api {
          */
         void QueryRange(const AABBT& range,std::vector<uint32_t>& outIds, uint32_t queryMask) const;
 
+        /// Igual, para listas temporárias em memória de frame (FrameArena).
+        void QueryRange(const AABBT& range,std::pmr::vector<uint32_t>& outIds, uint32_t queryMask) const;
+
         /**
          * @brief Query objects containing a point.
          * @param p Point to test.
@@ -156,6 +168,23 @@ namespace cp_api {
          */
         void GetLeafNodes(std::vector<const Node*>& out) const;
 
+        /**
+         * @brief Collect every node (leaf or internal) that stores at least one item.
+         */
+        void GetItemNodes(std::vector<const Node*>& out) const;
+        void GetItemNodes(std::vector<Node*>& out); // para preencher Node::userIndex
+
+        /**
+         * @brief Collect nodes whose bounds intersect a range and that store items.
+         * Items are not tested individually; callers run their own narrowphase per node.
+         * @param range Query bounds.
+         * @param out Output vector of nodes.
+         */
+        void QueryNodes(const AABBT& range, std::vector<const Node*>& out) const;
+
+        /// Igual, para listas temporárias em memória de frame (FrameArena).
+        void QueryNodes(const AABBT& range, std::pmr::vector<const Node*>& out) const;
+
         const std::optional<std::reference_wrapper<const Entry>> FindEntry(uint32_t id) const {
             const Entry* result = nullptr;
             Traverse([&](const Entry& e) {
@@ -249,12 +278,14 @@ namespace cp_api {
 
         // Internal helpers
         void insert(Node& node,const Entry& e);
+        void bulkLoad(Node& node,std::vector<Entry>&& entries);
         bool remove(Node& node,uint32_t id,const AABBT& bounds);
         void clear(Node& node) noexcept;
         int childIndexFor(const Node& node,const AABBT& b) const;
         void subdivide(Node& node);
 
-        void query(const Node& node,const AABBT& range,std::vector<uint32_t>& out, uint32_t queryMask) const;
+        template<typename OutIds>
+        void query(const Node& node,const AABBT& range,OutIds& out, uint32_t queryMask) const;
         void queryPointNode(const Node& node,const VecT& p,std::vector<uint32_t>& out) const;
         size_t queryRangeCallbackNode(const Node& node,const AABBT& range,const std::function<bool(uint32_t,const AABBT&)>& cb) const;
 
@@ -263,6 +294,9 @@ namespace cp_api {
 
         void collectItems(const Node& node,std::vector<uint32_t>& out) const;
         void collectLeafNodes(const Node& node,std::vector<const Node*>& out) const;
+        void collectItemNodes(const Node& node,std::vector<const Node*>& out) const;
+        template<typename OutNodes>
+        void queryNodes(const Node& node,const AABBT& range,OutNodes& out) const;
 
         size_t nodeCount(const Node& node) const noexcept;
     };
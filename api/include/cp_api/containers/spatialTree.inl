@@ -33,6 +33,14 @@ void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::Insert(uint32_t id
     ++m_count;
 }
 
+template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
+void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::BulkLoad(std::vector<Entry>&& entries)
+{
+    Clear();
+    m_count = entries.size();
+    bulkLoad(*m_root, std::move(entries));
+}
+
 template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
 bool cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::Remove(uint32_t id,const AABBT& bounds)
 {
@@ -85,6 +93,12 @@ void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::QueryRange(const A
     query(*m_root, range, outIds, queryMask);
 }
 
+template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
+void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::QueryRange(const AABBT& range,std::pmr::vector<uint32_t>& outIds, uint32_t queryMask) const
+{
+    query(*m_root, range, outIds, queryMask);
+}
+
 template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
 void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::QueryPoint(const VecT& p,std::vector<uint32_t>& outIds) const
 {
@@ -166,6 +180,37 @@ void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::GetLeafNodes(std::
     collectLeafNodes(*m_root, out);
 }
 
+// =============================
+// Collect nodes holding items
+// =============================
+template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
+void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::GetItemNodes(std::vector<const Node*>& out) const
+{
+    collectItemNodes(*m_root, out);
+}
+
+template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
+void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::GetItemNodes(std::vector<Node*>& out)
+{
+    std::vector<const Node*> nodes;
+    collectItemNodes(*m_root, nodes);
+    out.reserve(out.size() + nodes.size());
+    for (const Node* node : nodes)
+        out.push_back(const_cast<Node*>(node)); // a árvore não é const aqui
+}
+
+template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
+void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::QueryNodes(const AABBT& range, std::vector<const Node*>& out) const
+{
+    queryNodes(*m_root, range, out);
+}
+
+template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
+void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::QueryNodes(const AABBT& range, std::pmr::vector<const Node*>& out) const
+{
+    queryNodes(*m_root, range, out);
+}
+
 // =============================
 // Internal Helpers
 // =============================
@@ -195,23 +240,53 @@ void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::insert(Node& node,
         if (!node.subdivided)
             subdivide(node);
 
-        // Tentativa de redistribuição dos objetos existentes
-        std::vector<Entry> remaining;
-        remaining.reserve(node.items.size());
-
-        for (auto& i : node.items)
+        // Tentativa de redistribuição dos objetos existentes; compacta no próprio vetor
+        // (os filhos têm vetores próprios, então inserir neles não mexe em node.items)
+        size_t kept = 0;
+        for (size_t k = 0; k < node.items.size(); ++k)
         {
+            auto& i = node.items[k];
             int idx = childIndexFor(node, i.bounds);
             if (idx >= 0 && node.children[idx]->bounds.Contains(i.bounds))
                 insert(*node.children[idx], i);
-            else
-                remaining.push_back(std::move(i)); // mantém no pai
+            else if (kept++ != k)
+                node.items[kept - 1] = std::move(i); // mantém no pai
         }
 
-        node.items.swap(remaining);
+        node.items.erase(node.items.begin() + kept, node.items.end());
     }
 }
 
+template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
+void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::bulkLoad(Node& node, std::vector<Entry>&& entries)
+{
+    // Mesma regra de insert(): só subdivide acima da capacidade e abaixo da profundidade máxima
+    if (entries.size() <= (size_t)m_capacity || node.depth >= m_maxDepth)
+    {
+        node.items = std::move(entries);
+        return;
+    }
+
+    subdivide(node);
+
+    std::vector<Entry> buckets[ChildCount];
+    for (auto& e : entries)
+    {
+        int idx = childIndexFor(node, e.bounds);
+        if (idx >= 0 && node.children[idx]->bounds.Contains(e.bounds))
+            buckets[idx].push_back(e);
+        else
+            node.items.push_back(e); // cruza limites → permanece neste nó
+    }
+
+    entries.clear();
+    entries.shrink_to_fit();
+
+    for (int c = 0; c < ChildCount; ++c)
+        if (!buckets[c].empty())
+            bulkLoad(*node.children[c], std::move(buckets[c]));
+}
+
 template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
 bool cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::remove(Node& node, uint32_t id, const AABBT& bounds)
 {
@@ -357,10 +432,11 @@ void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::subdivide(Node& no
 // Query / Raycast Helpers
 // =============================
 template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
+template<typename OutIds>
 void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::query(
     const Node& node,
     const AABBT& range,
-    std::vector<uint32_t>& out,
+    OutIds& out,
     uint32_t queryMask
 ) const
 {
@@ -482,6 +558,29 @@ void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::collectLeafNodes(
     for(int c=0;c<ChildCount;++c) collectLeafNodes(*node.children[c], out);
 }
 
+template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
+void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::collectItemNodes(
+    const Node& node,
+    std::vector<const Node*>& out
+) const
+{
+    if(!node.items.empty()) out.push_back(&node);
+    if(node.subdivided) for(int c=0;c<ChildCount;++c) collectItemNodes(*node.children[c], out);
+}
+
+template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
+template<typename OutNodes>
+void cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::queryNodes(
+    const Node& node,
+    const AABBT& range,
+    OutNodes& out
+) const
+{
+    if(!node.bounds.Intersects(range)) return;
+    if(!node.items.empty()) out.push_back(&node);
+    if(node.subdivided) for(int c=0;c<ChildCount;++c) queryNodes(*node.children[c], range, out);
+}
+
 template<typename VecT, typename AABBT, typename RayT, typename RayHitT, int ChildCount>
 size_t cp_api::SpatialTree<VecT,AABBT,RayT,RayHitT,ChildCount>::nodeCount(const Node& node) const noexcept
 {
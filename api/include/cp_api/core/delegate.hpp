@@ -1,11 +1,17 @@
 #pragma once
 #include <functional>
-#include <mutex>
+#include <memory>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <new>
 #include <type_traits>
 
+#include "cp_api/core/snapshot.hpp"
+
 #ifdef _DEBUG
 #include "cp_api/core/debug.hpp"
 #define CP_DELEGATE_LOG(...) CP_LOG_INFO(__VA_ARGS__)
@@ -22,39 +28,77 @@ namespace cp_api {
     // ========================================================
     // SINGLE DELEGATE
     // ========================================================
-    template<typename Signature>
+    /**
+     * @brief Callable com armazenamento inline de `InlineSize` bytes: nunca aloca.
+     *
+     * Callables triviais (métodos, ponteiros, lambdas simples) comparam por valor; os outros só
+     * são iguais a si mesmos.
+     */
+    template<typename Signature, size_t InlineSize = 64>
     class Delegate;
 
-    template<typename R, typename... Args>
-    class Delegate<R(Args...)>
+    template<typename R, typename... Args, size_t InlineSize>
+    class Delegate<R(Args...), InlineSize>
     {
     public:
         using FuncType = std::function<R(Args...)>;
+        static constexpr size_t StorageSize = InlineSize;
 
         Delegate() = default;
 
-         // Construtor a partir de função livre ou callable compatível
-        Delegate(FuncType f) : func_(std::move(f)) {}
+        // Construtor a partir de função livre ou callable compatível
+        template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Delegate>
+                                                         && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+        Delegate(F&& f) { Bind(std::forward<F>(f)); }
 
-        template<typename T>
-        static Delegate<T> FromFunction(const std::function<T>& func) {
-            Delegate<T> del;
-            del.SetFunction(func); // depende de como você implementou Delegate
-            return del;
+        Delegate(const Delegate& other) { copyFrom(other); }
+        Delegate(Delegate&& other) noexcept { moveFrom(other); }
+
+        Delegate& operator=(const Delegate& other)
+        {
+            if (this != &other) { reset(); copyFrom(other); }
+            return *this;
+        }
+
+        Delegate& operator=(Delegate&& other) noexcept
+        {
+            if (this != &other) { reset(); moveFrom(other); }
+            return *this;
+        }
+
+        ~Delegate() { reset(); }
+
+        static Delegate FromFunction(const FuncType& func) {
+            return Delegate(func);
         }
 
         // Factory para lambda ou std::function
-        static Delegate FromLambda(FuncType f) {
-            return Delegate(std::move(f));
+        template<typename F>
+        static Delegate FromLambda(F&& f) {
+            return Delegate(std::forward<F>(f));
+        }
+
+        template<typename T>
+        static Delegate FromMethod(T* instance, R(T::*method)(Args...)) {
+            Delegate del;
+            del.Bind(instance, method);
+            return del;
         }
 
         // Bind função/lambda
         template<typename F>
         void Bind(F&& f)
         {
-            func_ = std::forward<F>(f);
-            instance_ptr_ = nullptr;
-            method_id_ = 0;
+            using Fn = std::decay_t<F>;
+            static_assert(sizeof(Fn) <= InlineSize, "callable too large for Delegate inline storage (raise InlineSize)");
+            static_assert(alignof(Fn) <= alignof(std::max_align_t), "over-aligned callable");
+
+            reset();
+            std::memset(storage_, 0, sizeof(Fn)); // padding zerado: comparação por bytes fica estável
+            new (storage_) Fn(std::forward<F>(f));
+            invoke_ = &InvokeCallable<Fn>;
+            ops_ = IsTrivial<Fn> ? nullptr : &OpsFor<Fn>::value;
+            size_ = static_cast<uint32_t>(sizeof(Fn));
             CP_DELEGATE_LOG_DEBUG("[Delegate] Bound Lambda/Callable");
         }
 
@@ -62,11 +106,7 @@ namespace cp_api {
         template<typename T>
         void Bind(T* instance, R(T::*method)(Args...))
         {
-            func_ = [instance, method](Args... args) -> R {
-                return (instance->*method)(std::forward<Args>(args)...);
-            };
-            instance_ptr_ = instance;
-            method_id_ = MethodId(method);
+            bindMethod(BoundMethod<T, R(T::*)(Args...)>{ instance, method });
             CP_DELEGATE_LOG_DEBUG("[Delegate] Bound Method -> instance={} method={}", (void*)instance, typeid(method).name());
         }
 
@@ -74,56 +114,133 @@ namespace cp_api {
         template<typename T>
         void Bind(const T* instance, R(T::*method)(Args...) const)
         {
-            func_ = [instance, method](Args... args) -> R {
-                return (instance->*method)(std::forward<Args>(args)...);
-            };
-            instance_ptr_ = const_cast<T*>(instance);
-            method_id_ = MethodId(method);
+            bindMethod(BoundMethod<const T, R(T::*)(Args...) const>{ instance, method });
             CP_DELEGATE_LOG_DEBUG("[Delegate] Bound Const Method -> instance={} method={}", (void*)instance, typeid(method).name());
         }
 
         void Unbind()
         {
-            func_ = nullptr;
-            instance_ptr_ = nullptr;
-            method_id_ = 0;
+            reset();
             CP_DELEGATE_LOG_DEBUG("[Delegate] Unbind");
         }
 
-        bool Empty() const { return !static_cast<bool>(func_); }
+        bool Empty() const { return invoke_ == nullptr; }
+        explicit operator bool() const { return invoke_ != nullptr; }
 
-        void operator()(Args... args) const { Invoke(std::forward<Args>(args)...); }
+        R operator()(Args... args) const { return Invoke(std::forward<Args>(args)...); }
 
         R Invoke(Args... args) const
         {
-            if (func_) {
-                if constexpr (std::is_void_v<R>)
-                    func_(std::forward<Args>(args)...);
-                else
-                    return func_(std::forward<Args>(args)...);
+            if (invoke_)
+                return invoke_(storage_, std::forward<Args>(args)...);
+
+            if constexpr (!std::is_void_v<R>) {
+                if constexpr (std::is_default_constructible_v<R>) return R{};
+                else throw std::bad_function_call();
             }
         }
 
         bool operator==(const Delegate& other) const
         {
-            return instance_ptr_ == other.instance_ptr_ && method_id_ == other.method_id_;
+            if (this == &other) return true;
+            if (invoke_ != other.invoke_ || size_ != other.size_) return false;
+            if (ops_ || other.ops_) return false; // payload não trivial: sem comparação por valor
+            return std::memcmp(storage_, other.storage_, size_) == 0;
         }
 
     private:
         template<typename T, typename M>
-        static size_t MethodId(M T::*method)
+        struct BoundMethod {
+            T* instance;
+            M method;
+        };
+
+        // cópia/destruição de callables não triviais (nullptr = memcpy basta)
+        struct Ops {
+            void (*copy)(void* dst, const void* src);
+            void (*move)(void* dst, void* src);
+            void (*destroy)(void* p);
+        };
+
+        template<typename Fn>
+        static constexpr bool IsTrivial = std::is_trivially_copyable_v<Fn> && std::is_trivially_destructible_v<Fn>;
+
+        template<typename Fn>
+        struct OpsFor {
+            static constexpr Ops value{
+                [](void* dst, const void* src) { new (dst) Fn(*static_cast<const Fn*>(src)); },
+                [](void* dst, void* src) { new (dst) Fn(std::move(*static_cast<Fn*>(src))); },
+                [](void* p) { static_cast<Fn*>(p)->~Fn(); }
+            };
+        };
+
+        template<typename Fn>
+        static R InvokeCallable(const void* storage, Args... args)
         {
-            return reinterpret_cast<size_t>(*(void**)&method);
+            // callables mutáveis (lambda mutable) são aceitos como em std::function
+            return (*static_cast<Fn*>(const_cast<void*>(storage)))(std::forward<Args>(args)...);
         }
 
-        FuncType func_;
-        void* instance_ptr_ = nullptr;
-        size_t method_id_ = 0;
+        template<typename Bound>
+        static R InvokeMethod(const void* storage, Args... args)
+        {
+            const Bound& bound = *static_cast<const Bound*>(storage);
+            return (bound.instance->*bound.method)(std::forward<Args>(args)...);
+        }
+
+        template<typename Bound>
+        void bindMethod(const Bound& bound)
+        {
+            static_assert(sizeof(Bound) <= InlineSize, "member function pointer too large for Delegate inline storage");
+            reset();
+            std::memset(storage_, 0, sizeof(Bound));
+            new (storage_) Bound(bound);
+            invoke_ = &InvokeMethod<Bound>;
+            ops_ = nullptr;
+            size_ = static_cast<uint32_t>(sizeof(Bound));
+        }
+
+        void copyFrom(const Delegate& other)
+        {
+            if (other.ops_) other.ops_->copy(storage_, other.storage_);
+            else std::memcpy(storage_, other.storage_, other.size_);
+            invoke_ = other.invoke_;
+            ops_ = other.ops_;
+            size_ = other.size_;
+        }
+
+        void moveFrom(Delegate& other)
+        {
+            if (other.ops_) other.ops_->move(storage_, other.storage_);
+            else std::memcpy(storage_, other.storage_, other.size_);
+            invoke_ = other.invoke_;
+            ops_ = other.ops_;
+            size_ = other.size_;
+            other.reset();
+        }
+
+        void reset()
+        {
+            if (ops_) ops_->destroy(storage_);
+            invoke_ = nullptr;
+            ops_ = nullptr;
+            size_ = 0;
+        }
+
+        alignas(std::max_align_t) mutable std::byte storage_[InlineSize];
+        R (*invoke_)(const void*, Args...) = nullptr;
+        const Ops* ops_ = nullptr;
+        uint32_t size_ = 0;
     };
 
     // ========================================================
     // MULTICAST DELEGATE
     // ========================================================
+    /**
+     * @brief Delegates por prioridade; o broadcast lê um SnapshotCell, sem trava.
+     *
+     * Add/Remove durante um broadcast valem a partir do próximo.
+     */
     template<typename Signature>
     class MulticastDelegate;
 
@@ -132,65 +249,78 @@ namespace cp_api {
     {
     public:
         using DelegateType = Delegate<R(Args...)>;
+        using Handle = uint64_t;
 
         struct Entry
         {
             DelegateType delegate;
             int32_t priority = 0;
-            uint64_t callCount = 0;
+            Handle handle = 0;
+#ifdef _DEBUG
+            std::shared_ptr<std::atomic<uint64_t>> callCount; // compartilhado entre versões da lista
+#endif
         };
 
+        using EntryList = std::vector<Entry>;
+        using Snapshot = typename SnapshotCell<EntryList>::ReadGuard;
+
         // Adiciona delegate pronto
-        void Add(const DelegateType& del, int32_t priority = 0)
+        Handle Add(const DelegateType& del, int32_t priority = 0)
         {
-            std::scoped_lock lock(mutex_);
-            entries_.push_back({ del, priority, 0 });
-            SortEntries();
-            CP_DELEGATE_LOG("[MulticastDelegate] Added delegate -> total={}, priority={}", entries_.size(), priority);
+            const Handle handle = nextHandle_.fetch_add(1, std::memory_order_relaxed);
+#ifdef _DEBUG
+            Entry entry{ del, priority, handle, std::make_shared<std::atomic<uint64_t>>(0) };
+#else
+            Entry entry{ del, priority, handle }; // sem alocação por inscrição fora do debug
+#endif
+
+            entries_.Update([&](EntryList& list) {
+                // ordem por prioridade decrescente, estável entre iguais
+                auto pos = std::upper_bound(list.begin(), list.end(), priority,
+                                            [](int32_t p, const Entry& e) { return p > e.priority; });
+                list.insert(pos, std::move(entry));
+                CP_DELEGATE_LOG("[MulticastDelegate] Added delegate -> total={}, priority={}", list.size(), priority);
+            });
+            return handle;
         }
 
         // Bind função/lambda
         template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, DelegateType>>>
-        void Add(F&& f, int32_t priority = 0)
+        Handle Add(F&& f, int32_t priority = 0)
         {
             DelegateType del;
             del.Bind(std::forward<F>(f));
-            Add(del, priority);
+            return Add(del, priority);
         }
 
         // Bind método de instância
         template<typename T>
-        void Add(T* instance, R(T::*method)(Args...), int32_t priority = 0)
+        Handle Add(T* instance, R(T::*method)(Args...), int32_t priority = 0)
         {
             DelegateType del;
             del.Bind(instance, method);
-            Add(del, priority);
+            return Add(del, priority);
         }
 
         // Bind método const
         template<typename T>
-        void Add(const T* instance, R(T::*method)(Args...) const, int32_t priority = 0)
+        Handle Add(const T* instance, R(T::*method)(Args...) const, int32_t priority = 0)
         {
             DelegateType del;
             del.Bind(instance, method);
-            Add(del, priority);
+            return Add(del, priority);
         }
 
-        // Remove delegate específico
+        // Remove delegate específico (comparação por valor, ver Delegate::operator==)
         void Remove(const DelegateType& del)
         {
-            std::scoped_lock lock(mutex_);
-            size_t before = entries_.size();
-
-            entries_.erase(
-                std::remove_if(entries_.begin(), entries_.end(),
-                    [&](const Entry& e) { return e.delegate == del; }),
-                entries_.end()
-            );
-
-            size_t removed = before - entries_.size();
-            if (removed > 0)
-                CP_DELEGATE_LOG("[MulticastDelegate] Removed {} delegate(s), remaining={}", removed, entries_.size());
+            removeIf([&](const Entry& e) { return e.delegate == del; });
+        }
+
+        // Remove pelo handle devolvido em Add (funciona para qualquer callable)
+        void Remove(Handle handle)
+        {
+            removeIf([&](const Entry& e) { return e.handle == handle; });
         }
 
         // Remove método de instância
@@ -213,21 +343,23 @@ namespace cp_api {
 
         void Clear()
         {
-            std::scoped_lock lock(mutex_);
-            CP_DELEGATE_LOG("[MulticastDelegate] Clearing all delegates -> total before clear = {}", entries_.size());
-            entries_.clear();
+            entries_.Update([](EntryList& list) {
+                CP_DELEGATE_LOG("[MulticastDelegate] Clearing all delegates -> total before clear = {}", list.size());
+                if (list.empty()) return false;
+                list.clear();
+                return true;
+            });
         }
 
         bool Empty() const
         {
-            std::scoped_lock lock(mutex_);
-            return entries_.empty();
+            return entries_.Read()->empty();
         }
 
-        void operator()(Args... args)
+        void operator()(Args... args) const
         {
-            std::scoped_lock lock(mutex_);
-            const size_t total = entries_.size();
+            const Snapshot snapshot = entries_.Read();
+            const size_t total = snapshot->size();
 
             if (total == 0) {
                 CP_DELEGATE_LOG("=== Emissão abortada: nenhum delegate registrado ===");
@@ -237,15 +369,17 @@ namespace cp_api {
             CP_DELEGATE_LOG("=== Emitindo MulticastDelegate -> total delegates = {} ===", total);
             size_t idx = 1;
 
-            for (auto& e : entries_) {
+            for (const Entry& e : *snapshot) {
                 // Índice e chamada
                 CP_DELEGATE_LOG_DEBUG("[CALL {}/{}] Invocando delegate", idx, total);
 
                 // Invoca delegate
                 e.delegate.Invoke(std::forward<Args>(args)...);
 
+#ifdef _DEBUG
                 // Incrementa contador
-                e.callCount++;
+                e.callCount->fetch_add(1, std::memory_order_relaxed);
+#endif
 
                 // Log específico do delegate (info ou debug)
                 if (e.delegate.Empty()) {
@@ -255,28 +389,39 @@ namespace cp_api {
                 idx++;
             }
 
+#ifdef _DEBUG
             // Contadores resumidos após emissão
             CP_DELEGATE_LOG("Contadores após emissão:");
             idx = 1;
-            for (auto& e : entries_) {
-                CP_DELEGATE_LOG("    [{}] callCount = {}", idx, e.callCount);
+            for (const Entry& e : *snapshot) {
+                CP_DELEGATE_LOG("    [{}] callCount = {}", idx, e.callCount->load(std::memory_order_relaxed));
                 idx++;
             }
+#endif
 
             CP_DELEGATE_LOG("=== Fim da emissão ===");
         }
 
-        const std::vector<Entry>& GetEntries() const { return entries_; }
+        /// Snapshot imutável das entradas; mantém a versão viva enquanto existir.
+        Snapshot GetEntries() const { return entries_.Read(); }
 
     private:
-        void SortEntries()
+        template<typename Pred>
+        void removeIf(Pred&& pred)
         {
-            std::sort(entries_.begin(), entries_.end(),
-                [](const Entry& a, const Entry& b) { return a.priority > b.priority; });
+            entries_.Update([&](EntryList& list) {
+                const size_t before = list.size();
+                list.erase(std::remove_if(list.begin(), list.end(), pred), list.end());
+
+                const size_t removed = before - list.size();
+                if (removed > 0)
+                    CP_DELEGATE_LOG("[MulticastDelegate] Removed {} delegate(s), remaining={}", removed, list.size());
+                return removed > 0;
+            });
         }
 
-        mutable std::mutex mutex_;
-        std::vector<Entry> entries_;
+        SnapshotCell<EntryList> entries_;
+        std::atomic<Handle> nextHandle_{ 1 };
     };
 
 } // namespace cp_api
@@ -8,6 +8,7 @@
 #include <chrono>
 #include <mutex>
 #include "cp_api/core/debug.hpp"
+#include "cp_api/core/threadPoolStats.hpp"
 
 namespace cp_api {
 
@@ -173,6 +174,34 @@ namespace cp_api {
             return (it != m_timerSamplers.end()) ? it->second : dummy;
         }
 
+        // ---------------------------
+        // Orçamentos de memória (ex.: tiles de terreno residentes)
+        // ---------------------------
+        struct MemoryBudgetInfo {
+            size_t usedBytes = 0;
+            size_t budgetBytes = 0;
+        };
+
+        void ReportMemory(const std::string& name, size_t usedBytes, size_t budgetBytes) {
+            m_memoryBudgets[name] = { usedBytes, budgetBytes };
+        }
+
+        const MemoryBudgetInfo& GetMemoryBudget(const std::string& name) const {
+            static MemoryBudgetInfo dummy;
+            auto it = m_memoryBudgets.find(name);
+            return (it != m_memoryBudgets.end()) ? it->second : dummy;
+        }
+
+        // ---------------------------
+        // ThreadPool (ThreadPool::SnapshotStats, uma vez por frame)
+        // ---------------------------
+        void ReportThreadPool(ThreadPoolStats stats) {
+            m_threadPoolStats = std::move(stats);
+            m_hasThreadPoolStats = true;
+        }
+
+        const ThreadPoolStats& GetThreadPoolStats() const { return m_threadPoolStats; }
+
         // resumo em string
         std::string Summary() const {
             std::string out;
@@ -190,6 +219,32 @@ namespace cp_api {
                        " (min " + std::to_string(sampler.GetMin()) +
                        ", max " + std::to_string(sampler.GetMax()) + ")\n";
             }
+
+            if (!m_memoryBudgets.empty()) {
+                out += "Memory:\n";
+                for (const auto& [name, info] : m_memoryBudgets) {
+                    out += "   *" + name + " : " +
+                           std::to_string(info.usedBytes / (1024.0 * 1024.0)) + " MB / " +
+                           std::to_string(info.budgetBytes / (1024.0 * 1024.0)) + " MB\n";
+                }
+            }
+
+            if (m_hasThreadPoolStats) {
+                const ThreadPoolStats& tp = m_threadPoolStats;
+                out += "ThreadPool: " + std::to_string(tp.TotalTasks()) + " tasks in " +
+                       std::to_string(tp.intervalMs) + " ms, util " +
+                       std::to_string(static_cast<int>(tp.AverageUtilisation() * 100.0)) + "%" +
+                       ", latency p50 <" + std::to_string(static_cast<int>(tp.LatencyPercentileUs(0.5))) + " us" +
+                       ", p99 <" + std::to_string(static_cast<int>(tp.LatencyPercentileUs(0.99))) + " us\n";
+                for (size_t i = 0; i < tp.workers.size(); ++i) {
+                    const auto& w = tp.workers[i];
+                    out += "   *W" + std::to_string(i) + " : " +
+                           std::to_string(static_cast<int>(w.Utilisation() * 100.0)) + "% busy, " +
+                           std::to_string(w.tasksRun) + " tasks, steals " +
+                           std::to_string(w.stealsOk) + "/" + std::to_string(w.stealsOk + w.stealsFailed) +
+                           ", depth " + std::to_string(w.maxQueueDepth) + "\n";
+                }
+            }
             return out;
         }
 
@@ -202,6 +257,9 @@ namespace cp_api {
         FrameCounter m_frameCounter;
         std::unordered_map<std::string, uint64_t> m_timerStartTimes;
         std::unordered_map<std::string, TimerSampler> m_timerSamplers;
+        std::unordered_map<std::string, MemoryBudgetInfo> m_memoryBudgets;
+        ThreadPoolStats m_threadPoolStats;
+        bool m_hasThreadPoolStats = false;
     };
 
 } // namespace cp_api
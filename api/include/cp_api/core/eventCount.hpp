@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#endif
+
+namespace cp_api {
+
+    /// Dica de spin-wait para a CPU (PAUSE no x86).
+    inline void CpuRelax() {
+    #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_pause();
+    #elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+    #else
+        std::this_thread::yield();
+    #endif
+    }
+
+    /**
+     * @brief Estaciona em "sem trabalho" sem mutex e sem perder wakeups (std::atomic::wait).
+     * @code
+     *   auto key = ec.PrepareWait();
+     *   if (workAvailable()) { ec.CancelWait(); ... } else ec.CommitWait(key);
+     * @endcode
+     */
+    class EventCount {
+    public:
+        struct Key { uint32_t epoch; };
+
+        Key PrepareWait() {
+            m_waiters.fetch_add(1, std::memory_order_seq_cst);
+            return { m_epoch.load(std::memory_order_seq_cst) };
+        }
+
+        void CancelWait() {
+            m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+        }
+
+        void CommitWait(Key key) {
+            while (m_epoch.load(std::memory_order_acquire) == key.epoch)
+                m_epoch.wait(key.epoch, std::memory_order_acquire);
+            m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+        }
+
+        /// Acorda até `count` threads estacionadas. Barato quando ninguém espera.
+        void Notify(uint32_t count = 1) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint32_t waiters = m_waiters.load(std::memory_order_seq_cst);
+            if (waiters == 0 || count == 0)
+                return;
+
+            m_epoch.fetch_add(1, std::memory_order_seq_cst);
+            if (count >= waiters) {
+                m_epoch.notify_all();
+            } else {
+                for (uint32_t i = 0; i < count; ++i)
+                    m_epoch.notify_one();
+            }
+        }
+
+        void NotifyAll() { Notify(UINT32_MAX); }
+
+        uint32_t GetWaiterCount() const { return m_waiters.load(std::memory_order_relaxed); }
+
+    private:
+        alignas(64) std::atomic<uint32_t> m_epoch{ 0 };
+        alignas(64) std::atomic<uint32_t> m_waiters{ 0 };
+    };
+
+} // namespace cp_api
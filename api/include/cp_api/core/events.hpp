@@ -1,16 +1,21 @@
 #pragma once
 #include <functional>
-#include <unordered_map>
 #include <vector>
-#include <typeindex>
 #include <memory>
 #include <algorithm>
 #include <mutex>
+#include <array>
 #include <atomic>
-#include <queue>
-#include <optional>
-#include <thread>
-#include <condition_variable>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "cp_api/core/delegate.hpp"
+#include "cp_api/core/mpmcQueue.hpp"
+#include "cp_api/core/snapshot.hpp"
 
 namespace cp_api {
 
@@ -24,151 +29,509 @@ namespace cp_api {
     // ID para listener
     using ListenerID = uint64_t;
 
+    // ---------------------------
+    // IDs densos por tipo de evento
+    // ---------------------------
+    using EventTypeID = uint32_t;
+
+    namespace detail {
+        inline std::atomic<EventTypeID> g_nextEventTypeID{ 0 };
+    }
+
+    /// Índice denso de `EventType` (0, 1, 2, ... na ordem do primeiro uso); indexa a tabela de listeners.
+    template <typename EventType>
+    EventTypeID GetEventTypeID()
+    {
+        static const EventTypeID id = detail::g_nextEventTypeID.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    class ThreadPool;
+
+    // ---------------------------
+    // Despacho assíncrono no ThreadPool
+    // ---------------------------
+    struct AsyncDispatchConfig {
+        size_t strandCount = 0;        // filas seriais; 0 = uma por worker do pool
+        size_t maxPending = 1024;      // eventos em voo antes do backpressure
+        bool dropWhenFull = false;     // false: QueueEventAsync ajuda o pool até abrir espaço
+        bool fanOutListeners = true;   // listeners de mesma prioridade rodam em paralelo
+    };
+
+    /// Contadores do modo assíncrono desde StartAsync ou o último reset; latência como em ThreadPoolStats.
+    struct AsyncDispatchStats {
+        static constexpr size_t LatencyBucketCount = 16;
+
+        uint64_t queued = 0;
+        uint64_t dispatched = 0;
+        uint64_t dropped = 0;            // recusados com dropWhenFull (ou reentrantes com a fila cheia)
+        uint64_t backpressureStalls = 0; // vezes que um produtor teve de esperar
+        size_t pending = 0;
+        size_t maxPending = 0;
+        std::array<uint64_t, LatencyBucketCount> latency{};
+
+        /// Limite superior (µs) do bucket que contém o percentil `p` (0..1); 0 sem amostras.
+        double LatencyPercentileUs(double p) const {
+            uint64_t total = 0;
+            for (uint64_t c : latency) total += c;
+            if (total == 0) return 0.0;
+
+            const double target = p * static_cast<double>(total);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < LatencyBucketCount; ++i) {
+                seen += latency[i];
+                if (static_cast<double>(seen) >= target)
+                    return static_cast<double>(uint64_t(1) << i);
+            }
+            return static_cast<double>(uint64_t(1) << (LatencyBucketCount - 1));
+        }
+    };
+
     // ---------------------------
     // EventDispatcher avançado
     // ---------------------------
+    /**
+     * @brief Dispatcher publish/subscribe tipado.
+     *
+     * Tabela plana indexada por GetEventTypeID<EventType>(), listeners com a própria assinatura:
+     * Emit é um índice, um snapshot e chamadas diretas.
+     *
+     * Listeners de cada tipo num array copy-on-write (SnapshotCell): Emit lê um snapshot sem
+     * trava e um callback pode emitir ou (des)inscrever à vontade. Um Emit em andamento fica com
+     * o snapshot que pegou.
+     *
+     * Há também a fila adiada (QueueEvent + FlushQueued) e o despacho no ThreadPool (StartAsync).
+     */
     class EventDispatcher {
     public:
-        EventDispatcher() : m_nextListenerID(1) {}
+        /// Capacidade do ring de cada tipo usado com QueueEvent (arredondada p/ potência de 2).
+        static constexpr size_t DefaultQueueCapacity = 1024;
 
-        ~EventDispatcher() {
-            StopAsync();
-        }
+        EventDispatcher();
+        ~EventDispatcher();
+
+        EventDispatcher(const EventDispatcher&) = delete;
+        EventDispatcher& operator=(const EventDispatcher&) = delete;
 
         // Subscribes com prioridade opcional (default 0)
         template <typename EventType>
-        ListenerID Subscribe(std::function<void(const EventType&)> callback, int priority = 0)
+        ListenerID Subscribe(Delegate<void(const EventType&)> callback, int priority = 0)
         {
-            const std::type_index type = typeid(EventType);
-            std::unique_lock lock(m_mutex);
-
             ListenerID id = m_nextListenerID++;
-            auto wrapper = [callback](const Event& e) {
-                callback(static_cast<const EventType&>(e));
-            };
 
-            ListenerEntry entry{id, priority, wrapper};
-
-            auto& vec = m_listeners[type];
-            vec.push_back(entry);
+            acquireChannel<EventType>().listeners.Update([&](ListenerList<EventType>& list) {
+                // mantém a ordem por prioridade decrescente (estável entre iguais)
+                auto pos = std::upper_bound(list.begin(), list.end(), priority,
+                                            [](int p, const ListenerEntry<EventType>& e) { return p > e.priority; });
+                list.insert(pos, ListenerEntry<EventType>{ id, priority, std::move(callback) });
+            });
+            return id;
+        }
 
-            // ordena por prioridade decrescente
-            std::sort(vec.begin(), vec.end(),
-                      [](const ListenerEntry& a, const ListenerEntry& b) {
-                          return a.priority > b.priority;
-                      });
+        /// Recebe os EventType de um flush num span só, antes dos listeners por evento; Emit não chega aqui.
+        template <typename EventType>
+        ListenerID SubscribeBatch(Delegate<void(std::span<const EventType>)> callback, int priority = 0)
+        {
+            ListenerID id = m_nextListenerID++;
 
+            acquireChannel<EventType>().batchListeners.Update([&](BatchListenerList<EventType>& list) {
+                auto pos = std::upper_bound(list.begin(), list.end(), priority,
+                                            [](int p, const BatchListenerEntry<EventType>& e) { return p > e.priority; });
+                list.insert(pos, BatchListenerEntry<EventType>{ id, priority, std::move(callback) });
+            });
             return id;
         }
 
-        // Remove listener específico
+        // Remove listener específico (normal ou batch)
         template <typename EventType>
         void Unsubscribe(ListenerID id)
         {
-            const std::type_index type = typeid(EventType);
-            std::unique_lock lock(m_mutex);
+            Channel<EventType>* channel = findChannel<EventType>();
+            if (!channel) return;
 
-            auto it = m_listeners.find(type);
-            if (it == m_listeners.end()) return;
-
-            auto& vec = it->second;
-            vec.erase(std::remove_if(vec.begin(), vec.end(),
-                                     [id](const ListenerEntry& e){ return e.id == id; }),
-                      vec.end());
+            auto removeFrom = [id](auto& list) {
+                auto it = std::find_if(list.begin(), list.end(), [id](const auto& e) { return e.id == id; });
+                if (it == list.end()) return false;
+                list.erase(it);
+                return true;
+            };
+            if (!channel->listeners.Update(removeFrom))
+                channel->batchListeners.Update(removeFrom);
         }
 
         // Dispara evento imediatamente
         template <typename EventType>
         void Emit(const EventType& event)
         {
-            const std::type_index type = typeid(EventType);
-            std::unique_lock lock(m_mutex);
+            Channel<EventType>* channel = findChannel<EventType>();
+            if (!channel) return;
 
-            auto it = m_listeners.find(type);
-            if (it == m_listeners.end()) return;
-
-            for (auto& entry : it->second)
+            // snapshot: continua válido mesmo se alguém (des)inscrever durante os callbacks
+            const auto listeners = channel->listeners.Read();
+            for (const ListenerEntry<EventType>& entry : *listeners)
                 entry.callback(event);
         }
 
         // ---------------------------
-        // Suporte assíncrono
+        // Eventos adiados
         // ---------------------------
+        /// Guarda para o próximo FlushQueued(), sem trava (ring por tipo); ring cheio vai para a lista.
         template <typename EventType>
-        void QueueEvent(const EventType& event)
+        void QueueEvent(EventType event)
         {
-            std::unique_lock lock(m_queueMutex);
-            m_eventQueue.push(std::make_shared<EventWrapperTyped<EventType>>(event));
-            m_cv.notify_one();
+            static_assert(std::is_default_constructible_v<EventType> && std::is_move_assignable_v<EventType>,
+                          "queued events are stored in a ring and must be default-constructible and movable");
+            acquireChannel<EventType>().Push(std::move(event));
         }
 
-        void StartAsync()
+        /**
+         * @brief Despacha a fila, um tipo por vez, de uma thread num ponto fixo do frame. O que os
+         * listeners enfileiram fica para o próximo; chamada aninhada retorna 0.
+         * @return Eventos despachados.
+         */
+        size_t FlushQueued()
         {
-            m_running = true;
-            m_thread = std::thread([this]() { ProcessQueue(); });
+            if (m_flushing.exchange(true, std::memory_order_acquire))
+                return 0;
+
+            size_t dispatched = 0;
+            if (const ChannelTable* table = m_table.load(std::memory_order_acquire)) {
+                for (const auto& slot : table->slots) {
+                    if (ChannelBase* channel = slot.load(std::memory_order_acquire))
+                        dispatched += channel->Flush();
+                }
+            }
+
+            m_flushing.store(false, std::memory_order_release);
+            return dispatched;
         }
 
-        void StopAsync()
+        // ---------------------------
+        // Despacho assíncrono
+        // ---------------------------
+        /**
+         * @brief Despacha QueueEventAsync em `pool`, em strands seriais por (tipo, orderKey): mesma
+         * chave, ordem da fila. Com fanOutListeners, listeners de mesma prioridade rodam em paralelo.
+         * `pool` precisa viver até StopAsync (o destrutor chama): destrua o dispatcher antes do pool.
+         */
+        void StartAsync(ThreadPool& pool, const AsyncDispatchConfig& config = {});
+
+        /**
+         * @brief Para de aceitar e ajuda o pool até despachar o pendente (quem corre com ele tem o
+         * evento descartado). Depois disso o dispatcher não toca mais o pool.
+         */
+        void StopAsync();
+
+        bool IsAsync() const { return m_async.load(std::memory_order_acquire) != nullptr; }
+
+        /**
+         * @brief Acima de maxPending ajuda o pool até abrir espaço, ou descarta (dropWhenFull, ou
+         * de dentro de um listener). Sem StartAsync é um Emit.
+         * @return false se descartado.
+         */
+        template <typename EventType>
+        bool QueueEventAsync(EventType event, uint64_t orderKey = 0)
         {
-            if (m_running)
-            {
-                m_running = false;
-                m_cv.notify_one();
-                if (m_thread.joinable())
-                    m_thread.join();
+            // conta antes de ler m_async: StartAsync só recicla o estado parado com o contador em 0
+            AsyncProducerGuard producer(m_asyncProducers);
+            AsyncState* async = m_async.load(std::memory_order_seq_cst);
+            if (!async) {
+                producer.Release();
+                Emit(event);
+                return true;
             }
+            return postAsync(*async, AsyncJob::Make(std::move(event)), GetEventTypeID<EventType>(), orderKey);
         }
 
+        AsyncDispatchStats GetAsyncStats(bool reset = false);
+
     private:
+        template <typename EventType>
         struct ListenerEntry {
             ListenerID id;
             int priority;
-            std::function<void(const Event&)> callback;
+            Delegate<void(const EventType&)> callback;
         };
 
-        std::unordered_map<std::type_index, std::vector<ListenerEntry>> m_listeners;
-        std::mutex m_mutex;
-        std::atomic<ListenerID> m_nextListenerID;
+        template <typename EventType>
+        struct BatchListenerEntry {
+            ListenerID id;
+            int priority;
+            Delegate<void(std::span<const EventType>)> callback;
+        };
+
+        template <typename EventType>
+        using ListenerList = std::vector<ListenerEntry<EventType>>;
+
+        template <typename EventType>
+        using BatchListenerList = std::vector<BatchListenerEntry<EventType>>;
+
+        struct ChannelBase {
+            virtual ~ChannelBase() = default;
+            virtual size_t Flush() = 0;
+        };
+
+        // Um por tipo de evento; nunca é removido, então o ponteiro vale pela vida do dispatcher.
+        template <typename EventType>
+        struct Channel final : ChannelBase {
+            SnapshotCell<ListenerList<EventType>> listeners;
+            SnapshotCell<BatchListenerList<EventType>> batchListeners;
+
+            // fila adiada: criada no primeiro QueueEvent
+            std::atomic<MPMCQueue<EventType>*> queue{ nullptr };
+            std::atomic<bool> hasOverflow{ false };
+            std::mutex overflowMutex;
+            std::vector<EventType> overflow;
+            std::vector<EventType> batch; // só quem faz o flush mexe
+
+            ~Channel() override { delete queue.load(std::memory_order_relaxed); }
+
+            void Push(EventType&& event)
+            {
+                MPMCQueue<EventType>* ring = queue.load(std::memory_order_acquire);
+                if (!ring) {
+                    auto created = std::make_unique<MPMCQueue<EventType>>(DefaultQueueCapacity);
+                    if (queue.compare_exchange_strong(ring, created.get(), std::memory_order_acq_rel))
+                        ring = created.release();
+                }
+
+                if (ring->TryPush(std::move(event)))
+                    return;
+
+                std::lock_guard lock(overflowMutex);
+                overflow.push_back(std::move(event));
+                hasOverflow.store(true, std::memory_order_release);
+            }
+
+            size_t Flush() override
+            {
+                MPMCQueue<EventType>* ring = queue.load(std::memory_order_acquire);
+                if (!ring) return 0;
+
+                // só o que já estava na fila; o que os listeners enfileirarem fica p/ o próximo flush
+                batch.clear();
+                const size_t pending = ring->Size();
+                EventType event;
+                while (batch.size() < pending && ring->TryPop(event))
+                    batch.push_back(std::move(event));
+
+                if (hasOverflow.load(std::memory_order_acquire)) {
+                    std::lock_guard lock(overflowMutex);
+                    std::move(overflow.begin(), overflow.end(), std::back_inserter(batch));
+                    overflow.clear();
+                    hasOverflow.store(false, std::memory_order_relaxed);
+                }
+
+                if (batch.empty()) return 0;
+
+                const std::span<const EventType> events(batch);
+                {
+                    const auto batchSnapshot = batchListeners.Read();
+                    for (const BatchListenerEntry<EventType>& entry : *batchSnapshot)
+                        entry.callback(events);
+                }
+                {
+                    const auto snapshot = listeners.Read();
+                    for (const EventType& e : events)
+                        for (const ListenerEntry<EventType>& entry : *snapshot)
+                            entry.callback(e);
+                }
+                return events.size();
+            }
+        };
+
+        // Tabela plana indexada por EventTypeID. Cresce por cópia; as antigas ficam vivas até o
+        // destrutor porque um Emit pode estar lendo uma delas (crescimento geométrico, poucas).
+        struct ChannelTable {
+            explicit ChannelTable(size_t size) : slots(size) {}
+            std::vector<std::atomic<ChannelBase*>> slots;
+        };
+
+        template <typename EventType>
+        Channel<EventType>* findChannel() const
+        {
+            const EventTypeID type = GetEventTypeID<EventType>();
+            const ChannelTable* table = m_table.load(std::memory_order_acquire);
+            if (!table || type >= table->slots.size()) return nullptr;
+            return static_cast<Channel<EventType>*>(table->slots[type].load(std::memory_order_acquire));
+        }
+
+        template <typename EventType>
+        Channel<EventType>& acquireChannel()
+        {
+            if (Channel<EventType>* channel = findChannel<EventType>())
+                return *channel;
+
+            std::lock_guard lock(m_channelMutex);
+            if (Channel<EventType>* channel = findChannel<EventType>())
+                return *channel;
+
+            const EventTypeID type = GetEventTypeID<EventType>();
+            ChannelTable* table = m_table.load(std::memory_order_relaxed);
+            if (!table || type >= table->slots.size()) {
+                size_t size = table ? table->slots.size() : 16;
+                while (size <= type) size *= 2;
+
+                auto grown = std::make_unique<ChannelTable>(size);
+                if (table) {
+                    for (size_t i = 0; i < table->slots.size(); ++i)
+                        grown->slots[i].store(table->slots[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+                }
+                table = grown.get();
+                m_tables.push_back(std::move(grown));
+            }
+
+            auto channel = std::make_unique<Channel<EventType>>();
+            Channel<EventType>* raw = channel.get();
+            m_channels.push_back(std::move(channel));
+
+            table->slots[type].store(raw, std::memory_order_release);
+            m_table.store(table, std::memory_order_release);
+            return *raw;
+        }
 
         // ---------------------------
-        // Fila assíncrona
+        // Assíncrono
         // ---------------------------
-        struct EventWrapper {
-            virtual ~EventWrapper() = default;
-            virtual void Dispatch(EventDispatcher* dispatcher) = 0;
+        // Evento com tipo apagado; eventos pequenos ficam inline (sem alocação).
+        class AsyncJob {
+        public:
+            static constexpr size_t InlineSize = 48;
+
+            AsyncJob() = default;
+            AsyncJob(AsyncJob&& other) noexcept { moveFrom(other); }
+            AsyncJob& operator=(AsyncJob&& other) noexcept {
+                if (this != &other) { reset(); moveFrom(other); }
+                return *this;
+            }
+            ~AsyncJob() { reset(); }
+
+            template <typename EventType>
+            static AsyncJob Make(EventType&& event)
+            {
+                using T = std::remove_cvref_t<EventType>;
+                AsyncJob job;
+                if constexpr (sizeof(T) <= InlineSize && alignof(T) <= alignof(std::max_align_t)
+                              && std::is_nothrow_move_constructible_v<T>) {
+                    static constexpr Ops ops{
+                        [](EventDispatcher& d, void* p) { d.dispatchAsync(*static_cast<const T*>(p)); },
+                        [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); static_cast<T*>(src)->~T(); },
+                        [](void* p) { static_cast<T*>(p)->~T(); }
+                    };
+                    new (job.m_storage) T(std::forward<EventType>(event));
+                    job.m_ops = &ops;
+                } else {
+                    static constexpr Ops ops{
+                        [](EventDispatcher& d, void* p) { d.dispatchAsync(**static_cast<T**>(p)); },
+                        [](void* dst, void* src) { *static_cast<T**>(dst) = *static_cast<T**>(src); },
+                        [](void* p) { delete *static_cast<T**>(p); }
+                    };
+                    *reinterpret_cast<T**>(job.m_storage) = new T(std::forward<EventType>(event));
+                    job.m_ops = &ops;
+                }
+                return job;
+            }
+
+            void Run(EventDispatcher& dispatcher) { m_ops->invoke(dispatcher, m_storage); }
+            explicit operator bool() const { return m_ops != nullptr; }
+
+            uint64_t enqueueNs = 0;
+
+        private:
+            struct Ops {
+                void (*invoke)(EventDispatcher&, void*);
+                void (*relocate)(void* dst, void* src);
+                void (*destroy)(void*);
+            };
+
+            void moveFrom(AsyncJob& other) {
+                m_ops = std::exchange(other.m_ops, nullptr);
+                enqueueNs = other.enqueueNs;
+                if (m_ops) m_ops->relocate(m_storage, other.m_storage);
+            }
+            void reset() {
+                if (m_ops) m_ops->destroy(m_storage);
+                m_ops = nullptr;
+            }
+
+            alignas(std::max_align_t) std::byte m_storage[InlineSize];
+            const Ops* m_ops = nullptr;
         };
 
-        template <typename T>
-        struct EventWrapperTyped : EventWrapper {
-            T event;
-            EventWrapperTyped(const T& e) : event(e) {}
-            void Dispatch(EventDispatcher* dispatcher) override { dispatcher->Emit(event); }
+        struct AsyncState;
+        struct AsyncStrand;
+
+        class AsyncProducerGuard {
+        public:
+            explicit AsyncProducerGuard(std::atomic<uint32_t>& count) : m_count(&count) {
+                m_count->fetch_add(1, std::memory_order_seq_cst);
+            }
+            ~AsyncProducerGuard() { Release(); }
+
+            AsyncProducerGuard(const AsyncProducerGuard&) = delete;
+            AsyncProducerGuard& operator=(const AsyncProducerGuard&) = delete;
+
+            void Release() {
+                if (m_count) std::exchange(m_count, nullptr)->fetch_sub(1, std::memory_order_release);
+            }
+
+        private:
+            std::atomic<uint32_t>* m_count;
         };
 
-        std::queue<std::shared_ptr<EventWrapper>> m_eventQueue;
-        std::mutex m_queueMutex;
-        std::condition_variable m_cv;
-        std::thread m_thread;
-        std::atomic<bool> m_running{false};
+        bool postAsync(AsyncState& async, AsyncJob&& job, EventTypeID type, uint64_t orderKey);
+        bool asyncFanOut() const;
+        void scheduleDrain(AsyncState& async, AsyncStrand& strand);
+        void drainStrand(AsyncState& async, AsyncStrand& strand);
+        // Roda run(ctx, i) para i em [0, count) no pool e espera (ajudando).
+        void fanOut(size_t count, void (*run)(const void* ctx, size_t index), const void* ctx);
 
-        void ProcessQueue()
+        template <typename EventType>
+        void dispatchAsync(const EventType& event)
         {
-            while (m_running)
-            {
-                std::shared_ptr<EventWrapper> ev;
+            Channel<EventType>* channel = findChannel<EventType>();
+            if (!channel) return;
 
-                {
-                    std::unique_lock lock(m_queueMutex);
-                    m_cv.wait(lock, [this]() { return !m_eventQueue.empty() || !m_running; });
-                    if (!m_running) break;
+            const auto snapshot = channel->listeners.Read();
+            const ListenerList<EventType>& list = *snapshot;
+            if (!asyncFanOut()) {
+                for (const ListenerEntry<EventType>& entry : list)
+                    entry.callback(event);
+                return;
+            }
 
-                    ev = m_eventQueue.front();
-                    m_eventQueue.pop();
-                }
+            // grupos de mesma prioridade em paralelo, um grupo depois do outro
+            for (size_t begin = 0; begin < list.size();) {
+                size_t end = begin + 1;
+                while (end < list.size() && list[end].priority == list[begin].priority) ++end;
 
-                if (ev) ev->Dispatch(this);
+                if (end - begin == 1) {
+                    list[begin].callback(event);
+                } else {
+                    struct Group { const ListenerEntry<EventType>* entries; const EventType* event; };
+                    const Group group{ &list[begin], &event };
+                    fanOut(end - begin, [](const void* ctx, size_t i) {
+                        const Group& g = *static_cast<const Group*>(ctx);
+                        g.entries[i].callback(*g.event);
+                    }, &group);
+                }
+                begin = end;
             }
         }
+
+        std::atomic<ListenerID> m_nextListenerID;
+        std::atomic<ChannelTable*> m_table{ nullptr };
+        std::vector<std::unique_ptr<ChannelTable>> m_tables;     // atual + antigas
+        std::vector<std::unique_ptr<ChannelBase>> m_channels;
+        std::mutex m_channelMutex; // só criação de canal
+
+        std::atomic<bool> m_flushing{ false };
+
+        // StopAsync só zera o ponteiro: um produtor que leu o ponteiro antes vê accepting == false
+        // e descarta. O StartAsync seguinte espera m_asyncProducers == 0 e recicla (ou troca) o estado.
+        std::atomic<AsyncState*> m_async{ nullptr };
+        std::unique_ptr<AsyncState> m_asyncState; // atual ou parado
+        std::atomic<uint32_t> m_asyncProducers{ 0 }; // QueueEventAsync entre ler m_async e terminar
     };
 
 } // namespace cp_api
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace cp_api {
+
+    /**
+     * @brief Linear (bump) allocator for memory that only lives during one frame.
+     *
+     * Memory comes from chunks that are kept across frames, so once the arena has grown to a
+     * frame's peak, steady-state frames don't call malloc at all. deallocate() only gives memory
+     * back when it is the most recent allocation (vector growth, LIFO temporaries); everything
+     * else is reclaimed when the arena is reset.
+     *
+     * Every ThreadPool worker owns one (the main thread uses worker 0's inside a MainThreadScope).
+     * ThreadPool::ResetFrameArenas() bumps an epoch and each arena rewinds itself at its next
+     * allocation outside any Scope, so only the owning thread ever touches it and memory of a
+     * live Scope (e.g. a task spanning the end of the frame) is never reused under it. Memory
+     * taken outside a Scope must not be kept across frames.
+     *
+     * @code
+     *   FrameArena::Scope scratch; // devolve tudo ao sair do escopo
+     *   std::pmr::vector<uint32_t> ids(scratch.Resource());
+     * @endcode
+     */
+    class FrameArena final : public std::pmr::memory_resource {
+    public:
+        explicit FrameArena(size_t chunkSize = 64 * 1024);
+        ~FrameArena() override;
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        /// Volta ao início mantendo os chunks.
+        void Reset();
+
+        /// Faz o arena se rebobinar sozinho quando `*epoch` mudar (ThreadPool::ResetFrameArenas).
+        void SetEpochSource(const std::atomic<uint64_t>* epoch) { m_epochSource = epoch; }
+
+        struct Marker {
+            size_t chunk = 0;
+            size_t offset = 0;
+        };
+        Marker GetMarker() const { return { m_chunk, m_offset }; }
+        void Rewind(Marker marker);
+
+        size_t GetUsedBytes() const;
+        size_t GetCapacity() const { return m_capacity; }
+        size_t GetHighWater() const { return m_highWater; }
+
+        // ---------------------------
+        // Arena da thread atual
+        // ---------------------------
+        static FrameArena* Current();
+        static void SetCurrent(FrameArena* arena);
+
+        /// Arena da thread, ou new_delete_resource() fora dos workers.
+        static std::pmr::memory_resource* CurrentResource();
+
+        /**
+         * @brief Rewinds the current thread's arena to where it was on construction.
+         * Every container using Resource() must be destroyed before the scope ends, and containers
+         * from an enclosing scope on the same arena must not grow inside it.
+         */
+        class Scope {
+        public:
+            Scope() : m_arena(Current()) {
+                if (!m_arena) return;
+                m_marker = m_arena->GetMarker();
+                ++m_arena->m_scopeDepth;
+            }
+            ~Scope() {
+                if (!m_arena) return;
+                --m_arena->m_scopeDepth;
+                m_arena->Rewind(m_marker);
+            }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+            std::pmr::memory_resource* Resource() const {
+                return m_arena ? static_cast<std::pmr::memory_resource*>(m_arena) : std::pmr::new_delete_resource();
+            }
+
+        private:
+            FrameArena* m_arena;
+            Marker m_marker;
+        };
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    private:
+        struct Chunk {
+            std::byte* data = nullptr;
+            size_t size = 0;
+        };
+
+        void checkEpoch();
+
+        std::vector<Chunk> m_chunks;
+        size_t m_chunkSize;
+        size_t m_chunk = 0;  // chunk atual
+        size_t m_offset = 0; // topo dentro do chunk atual
+        size_t m_capacity = 0;
+        size_t m_highWater = 0;
+
+        const std::atomic<uint64_t>* m_epochSource = nullptr;
+        uint64_t m_epoch = 0;
+        uint32_t m_scopeDepth = 0; // Scopes abertos: o reset do epoch espera chegar a 0
+    };
+
+} // namespace cp_api
@@ -7,7 +7,7 @@
 namespace cp_api {
     // =======================================
     // HybridEventDispatcher
-    // Combina EventDispatcher assíncrono com Delegates
+    // Combina EventDispatcher (imediato + adiado) com Delegates
     // =======================================
     class HybridEventDispatcher : public EventDispatcher {
     public:
@@ -20,14 +20,8 @@ namespace cp_api {
         template<typename EventType>
         ListenerID Subscribe(const Delegate<void(const EventType&)>& del, int priority = 0)
         {
-            // Captura o delegate para lambda
-            Delegate<void(const EventType&)> localDel = del;
-
-            return this->EventDispatcher::template Subscribe<EventType>(
-                [localDel](const EventType& e) {
-                    localDel.Invoke(e);
-                }, priority
-            );
+            // o listener guarda o delegate por valor (inline, sem alocação)
+            return this->EventDispatcher::template Subscribe<EventType>(del, priority);
         }
 
         // ---------------------------
@@ -60,18 +54,12 @@ namespace cp_api {
         }
 
         // ---------------------------
-        // QueueEvent (assíncrono)
+        // QueueEvent (adiado até FlushQueued)
         // ---------------------------
         template<typename EventType>
         void QueueEvent(const EventType& e)
         {
             this->EventDispatcher::QueueEvent<EventType>(e);
         }
-
-        // ---------------------------
-        // Start/Stop thread assíncrono
-        // ---------------------------
-        void StartAsync() { EventDispatcher::StartAsync(); }
-        void StopAsync()  { EventDispatcher::StopAsync(); }
     };
 }
\ No newline at end of file
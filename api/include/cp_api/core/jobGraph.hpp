@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cp_api/core/threadPool.hpp"
+
+namespace cp_api {
+
+    /**
+     * @brief Dependency graph of jobs (DAG) executed on the ThreadPool.
+     *
+     * Nodes are added once with their dependencies and the graph is re-run every frame.
+     * Each node owns an atomic join counter preset to its number of predecessors; a finishing
+     * node decrements its successors and dispatches the ones that reach zero as continuations
+     * from the same worker, so no thread ever blocks on a future inside the graph.
+     *
+     * @code
+     *   JobGraph graph;
+     *   auto cull    = graph.AddNode("Cull", [&]{ ... });
+     *   auto physics = graph.AddNode("Physics", [&]{ ... });
+     *   auto render  = graph.AddNode("Render", [&]{ ... });
+     *   graph.AddDependency(cull, render);
+     *   // cada frame:
+     *   graph.Run(pool);
+     *   graph.Wait();
+     * @endcode
+     */
+    class JobGraph {
+    public:
+        using NodeId = uint32_t;
+
+        JobGraph() = default;
+        ~JobGraph();
+
+        JobGraph(const JobGraph&) = delete;
+        JobGraph& operator=(const JobGraph&) = delete;
+
+        NodeId AddNode(std::string name, std::function<void()> job, TaskPriority priority = TaskPriority::NORMAL);
+
+        /// `after` só roda quando `before` terminar.
+        void AddDependency(NodeId before, NodeId after);
+
+        /// Remove todos os nós (não pode estar rodando).
+        void Clear();
+
+        /**
+         * @brief Start one execution of the graph; returns immediately.
+         * Root nodes are dispatched to the pool, the rest follow as continuations.
+         * Throws if the graph has a cycle or is already running.
+         */
+        void Run(ThreadPool& pool);
+
+        /// Ajuda o pool até o fim da execução atual; relança a primeira exceção de um job.
+        void Wait();
+
+        void RunAndWait(ThreadPool& pool) { Run(pool); Wait(); }
+
+        bool IsRunning() const { return m_running.load(std::memory_order_acquire); }
+
+        size_t GetNodeCount() const { return m_nodes.size(); }
+        const std::string& GetNodeName(NodeId id) const { return m_nodes[id].name; }
+
+    private:
+        struct Node {
+            std::string name;
+            std::function<void()> job;
+            TaskPriority priority = TaskPriority::NORMAL;
+            std::vector<NodeId> successors;
+            uint32_t dependencyCount = 0;
+        };
+
+        void validate();
+        void dispatch(NodeId id);
+        void execute(NodeId id);
+
+    private:
+        std::vector<Node> m_nodes;
+        std::unique_ptr<std::atomic<uint32_t>[]> m_pending; // contadores de junção, um por nó
+        std::vector<NodeId> m_roots;
+        bool m_validated = false;
+
+        ThreadPool* m_pool = nullptr;
+        std::atomic<uint32_t> m_remaining{ 0 };
+
+        // término sinalizado sob o mutex: quem espera pode destruir o grafo logo depois
+        std::atomic<bool> m_running{ false };
+        std::mutex m_doneMutex;
+
+        std::mutex m_errorMutex;
+        std::exception_ptr m_error;
+    };
+
+} // namespace cp_api
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace cp_api {
+
+    /// Fila MPMC limitada (anel de Vyukov); TryPush falha cheia, TryPop vazia, nenhuma bloqueia.
+    template<typename T>
+    class MPMCQueue {
+    public:
+        explicit MPMCQueue(size_t capacity = 1024)
+        {
+            size_t cap = 2;
+            while (cap < capacity) cap <<= 1;
+            m_mask = cap - 1;
+            m_cells.reset(new Cell[cap]);
+            for (size_t i = 0; i < cap; ++i)
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        MPMCQueue(const MPMCQueue&) = delete;
+        MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+        bool TryPush(T item)
+        {
+            size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& cell = m_cells[pos & m_mask];
+                size_t seq = cell.sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+                if (diff == 0) {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.data = std::move(item);
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false; // cheia
+                } else {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool TryPop(T& out)
+        {
+            size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                Cell& cell = m_cells[pos & m_mask];
+                size_t seq = cell.sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+                if (diff == 0) {
+                    if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        out = std::move(cell.data);
+                        cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false; // vazia
+                } else {
+                    pos = m_dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Aproximado sob concorrência
+        size_t Size() const
+        {
+            size_t e = m_enqueuePos.load(std::memory_order_relaxed);
+            size_t d = m_dequeuePos.load(std::memory_order_relaxed);
+            return e > d ? e - d : 0;
+        }
+
+        bool Empty() const { return Size() == 0; }
+        size_t Capacity() const { return m_mask + 1; }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        std::unique_ptr<Cell[]> m_cells;
+        size_t m_mask = 0;
+        alignas(64) std::atomic<size_t> m_enqueuePos{ 0 };
+        alignas(64) std::atomic<size_t> m_dequeuePos{ 0 };
+    };
+
+} // namespace cp_api
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "cp_api/core/threadPool.hpp"
+
+namespace cp_api {
+
+    // ------------------------------------------------------------
+    // Algoritmos paralelos sobre o ThreadPool
+    // ------------------------------------------------------------
+    //
+    // Todos usam lazy binary splitting: quem processa um intervalo só divide a metade de cima
+    // em uma nova tarefa quando a própria fila está vazia (ThreadPool::HasIdleCapacity), e
+    // processa o resto em pedaços de `grain`. Assim o número de tarefas acompanha a demanda
+    // real de roubo em vez de n / grain.
+    //
+    // A thread que chama participa do trabalho e espera com ThreadPool::Wait (que executa
+    // tarefas enquanto espera), então chamar de dentro de um worker não causa deadlock.
+
+    namespace detail {
+
+        template<typename Index, typename RangeFn>
+        struct ParallelForContext {
+            ThreadPool& pool;
+            RangeFn& fn;
+            Index grain;
+            TaskCounter counter;
+
+            std::mutex errorMutex;
+            std::exception_ptr error;
+
+            void Run(Index begin, Index end)
+            {
+                try {
+                    while (begin < end) {
+                        // divide enquanto houver quem roube
+                        while (end - begin > grain && pool.HasIdleCapacity()) {
+                            Index mid = begin + (end - begin) / 2;
+                            pool.Dispatch(TaskPriority::HIGH, counter, [this, mid, end] { Run(mid, end); });
+                            end = mid;
+                        }
+
+                        Index chunkEnd = (end - begin > grain) ? begin + grain : end;
+                        fn(begin, chunkEnd);
+                        begin = chunkEnd;
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) error = std::current_exception();
+                }
+            }
+        };
+
+        /**
+         * Merge em paralelo de pares de runs adjacentes de `width` elementos, de src para dst.
+         * Cada merge também se divide (lazy, como ParallelForContext): a metade do maior lado é
+         * cortada na mediana e o outro lado no co-rank por busca binária, então o último nível
+         * (um par só, n elementos) não fica serial.
+         */
+        template<typename SrcIt, typename DstIt, typename Compare>
+        struct ParallelMergeContext {
+            ThreadPool& pool;
+            Compare& comp;
+            SrcIt src;
+            DstIt dst;
+            size_t n;
+            size_t width;
+            size_t grain; // >= 2: com menos o corte pode não reduzir nenhum dos lados
+            TaskCounter counter;
+
+            std::mutex errorMutex;
+            std::exception_ptr error;
+
+            void MergePair(size_t p)
+            {
+                size_t b = p * 2 * width;
+                size_t m = std::min(n, b + width);
+                size_t e = std::min(n, b + 2 * width);
+                Merge(src + b, src + m, src + m, src + e, dst + b);
+            }
+
+            // estável: empates saem de [a, aEnd) primeiro
+            void Merge(SrcIt a, SrcIt aEnd, SrcIt b, SrcIt bEnd, DstIt out)
+            {
+                try {
+                    while (static_cast<size_t>((aEnd - a) + (bEnd - b)) > grain && pool.HasIdleCapacity()) {
+                        SrcIt aMid, bMid;
+                        if (aEnd - a >= bEnd - b) {
+                            aMid = a + (aEnd - a) / 2;
+                            bMid = std::lower_bound(b, bEnd, *aMid, comp);
+                        } else {
+                            bMid = b + (bEnd - b) / 2;
+                            aMid = std::upper_bound(a, aEnd, *bMid, comp);
+                        }
+                        DstIt outMid = out + ((aMid - a) + (bMid - b));
+                        pool.Dispatch(TaskPriority::HIGH, counter, [this, aMid, aEnd, bMid, bEnd, outMid] {
+                            Merge(aMid, aEnd, bMid, bEnd, outMid);
+                        });
+                        aEnd = aMid;
+                        bEnd = bMid;
+                    }
+
+                    std::merge(std::make_move_iterator(a), std::make_move_iterator(aEnd),
+                               std::make_move_iterator(b), std::make_move_iterator(bEnd),
+                               out, comp);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) error = std::current_exception();
+                }
+            }
+        };
+
+        template<typename SrcIt, typename DstIt, typename Compare>
+        void ParallelMergeLevel(ThreadPool& pool, SrcIt src, DstIt dst, size_t n, size_t width, Compare& comp, size_t grain)
+        {
+            ParallelMergeContext<SrcIt, DstIt, Compare> ctx{ pool, comp, src, dst, n, width, std::max<size_t>(grain, 2) };
+
+            const size_t pairs = (n + 2 * width - 1) / (2 * width);
+            if (pairs > 1)
+                pool.DispatchBatch(TaskPriority::HIGH, ctx.counter, pairs - 1, [&ctx](size_t p) { ctx.MergePair(p + 1); });
+            ctx.MergePair(0);
+            pool.Wait(ctx.counter);
+
+            if (ctx.error)
+                std::rethrow_exception(ctx.error);
+        }
+
+    } // namespace detail
+
+    /**
+     * @brief Call fn(begin, end) over disjoint sub-ranges covering [begin, end).
+     * @param grain Smallest sub-range handed to fn (except the tail); tune so fn(grain) costs ~10 µs.
+     * Rethrows the first exception thrown by fn after all sub-ranges finished.
+     */
+    template<typename Index, typename RangeFn>
+    void ParallelForRange(ThreadPool& pool, Index begin, Index end, Index grain, RangeFn&& fn)
+    {
+        static_assert(std::is_integral_v<Index>, "ParallelForRange requires an integral index");
+        if (begin >= end) return;
+        if (grain < 1) grain = 1;
+
+        detail::ParallelForContext<Index, std::remove_reference_t<RangeFn>> ctx{ pool, fn, grain };
+        ctx.Run(begin, end);
+        pool.Wait(ctx.counter);
+
+        if (ctx.error)
+            std::rethrow_exception(ctx.error);
+    }
+
+    /// Chama fn(i) para cada i em [begin, end).
+    template<typename Index, typename Fn>
+    void ParallelFor(ThreadPool& pool, Index begin, Index end, Index grain, Fn&& fn)
+    {
+        ParallelForRange(pool, begin, end, grain, [&fn](Index b, Index e) {
+            for (Index i = b; i < e; ++i) fn(i);
+        });
+    }
+
+    /**
+     * @brief Parallel reduction over [begin, end).
+     *
+     * rangeFn(b, e, acc) folds a sub-range into acc and returns it; combine(a, b) merges partial
+     * results. One partial is kept per worker (cache-line padded), so combine must be associative
+     * and commutative; floating-point sums may differ in the last bits between runs.
+     */
+    template<typename T, typename Index, typename RangeFn, typename Combine>
+    T ParallelReduce(ThreadPool& pool, Index begin, Index end, Index grain, T identity, RangeFn&& rangeFn, Combine&& combine)
+    {
+        struct alignas(64) Partial { T value; };
+
+        const size_t workers = pool.GetWorkerCount();
+        std::vector<Partial> partials(workers, Partial{ identity });
+
+        // threads fora do pool (quem chamou ou quem ajuda em outro Wait) dividem um acumulador
+        std::mutex externalMutex;
+        T external = identity;
+
+        ParallelForRange(pool, begin, end, grain, [&](Index b, Index e) {
+            // acumula localmente primeiro: rangeFn pode esperar em outra tarefa e reentrar aqui
+            T local = rangeFn(b, e, identity);
+
+            size_t self = pool.CurrentWorkerIndex();
+            if (self != SIZE_MAX) {
+                partials[self].value = combine(std::move(partials[self].value), std::move(local));
+            } else {
+                std::lock_guard<std::mutex> lock(externalMutex);
+                external = combine(std::move(external), std::move(local));
+            }
+        });
+
+        T result = std::move(external);
+        for (Partial& p : partials)
+            result = combine(std::move(result), std::move(p.value));
+        return result;
+    }
+
+    /**
+     * @brief Parallel merge sort (stable).
+     *
+     * Sorts runs of at least `grain` elements in parallel with std::stable_sort, then merges pairs
+     * of runs level by level, ping-ponging with a temporary buffer. Each merge is itself split at
+     * binary-searched co-ranks while workers are idle, so the last levels use the whole pool. The
+     * value type must be default-constructible and movable.
+     */
+    template<typename RandomIt, typename Compare = std::less<>>
+    void ParallelSort(ThreadPool& pool, RandomIt first, RandomIt last, Compare comp = Compare{}, size_t grain = 4096)
+    {
+        using Value = typename std::iterator_traits<RandomIt>::value_type;
+        if (grain < 1) grain = 1;
+
+        const size_t n = static_cast<size_t>(last - first);
+        if (n <= grain || pool.GetWorkerCount() < 2) {
+            std::stable_sort(first, last, comp);
+            return;
+        }
+
+        // runs de tamanho potência de dois * grain, no máximo ~4 por worker
+        size_t runSize = grain;
+        while (n / runSize > pool.GetWorkerCount() * 4)
+            runSize *= 2;
+        const size_t runCount = (n + runSize - 1) / runSize;
+
+        ParallelFor(pool, size_t(0), runCount, size_t(1), [&](size_t r) {
+            size_t b = r * runSize;
+            size_t e = std::min(n, b + runSize);
+            std::stable_sort(first + b, first + e, comp);
+        });
+
+        std::vector<Value> buffer(n);
+        bool inBuffer = false; // onde estão os runs atuais
+
+        for (size_t width = runSize; width < n; width *= 2) {
+            if (inBuffer)
+                detail::ParallelMergeLevel(pool, buffer.begin(), first, n, width, comp, grain);
+            else
+                detail::ParallelMergeLevel(pool, first, buffer.begin(), n, width, comp, grain);
+            inBuffer = !inBuffer;
+        }
+
+        if (inBuffer)
+            std::move(buffer.begin(), buffer.end(), first);
+    }
+
+} // namespace cp_api
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+
+// ---------------------------
+// Seleção do backend SIMD
+// ---------------------------
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+    // só os TUs de kernels *AVX2.cpp (ver CMakeLists); o resto da lib fica no ISA padrão
+    #include <immintrin.h>
+    #define CP_SIMD_AVX 1
+    #define CP_SIMD_FMA 1
+    #define CP_SIMD_BACKEND avx2
+#elif defined(__AVX__)
+    #include <immintrin.h>
+    #define CP_SIMD_AVX 1
+    #define CP_SIMD_BACKEND avx
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CP_SIMD_SSE 1
+    #define CP_SIMD_BACKEND sse2
+#else
+    #define CP_SIMD_SCALAR 1
+    #define CP_SIMD_BACKEND scalar
+#endif
+
+namespace cp_api::simd {
+
+    /**
+     * @brief 8-lane float vector used by the SoA kernels (terrain narrowphase, transforms).
+     *
+     * The same kernel source compiles to AVX2+FMA / AVX (one register), SSE2 (two registers)
+     * or plain scalar code, so callers always process data in blocks of 8.
+     */
+    constexpr int Width = 8;
+
+    /// CPU e SO suportam AVX2 + FMA (escolha dos kernels *AVX2 em runtime).
+    bool HasAVX2();
+
+    // O backend entra no nome: os TUs de kernels compilados com AVX2 não misturam definições
+    // inline de Float8 com as do resto da lib. Width e os blocos SoA são iguais em todos.
+    inline namespace CP_SIMD_BACKEND {
+
+#if defined(CP_SIMD_AVX)
+
+    struct Mask8 { __m256 v; };
+    struct Float8 { __m256 v; };
+
+    inline Float8 Load(const float* p)          { return { _mm256_load_ps(p) }; }
+    inline Float8 LoadUnaligned(const float* p) { return { _mm256_loadu_ps(p) }; }
+    inline void   Store(float* p, Float8 a)     { _mm256_store_ps(p, a.v); }
+    inline Float8 Set1(float s)                 { return { _mm256_set1_ps(s) }; }
+    inline Float8 Zero()                        { return { _mm256_setzero_ps() }; }
+
+    inline Float8 operator+(Float8 a, Float8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+    inline Float8 operator-(Float8 a, Float8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+    inline Float8 operator*(Float8 a, Float8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+    inline Float8 operator/(Float8 a, Float8 b) { return { _mm256_div_ps(a.v, b.v) }; }
+    // a * b + c; com FMA é uma instrução e um arredondamento só
+#if defined(CP_SIMD_FMA)
+    inline Float8 MulAdd(Float8 a, Float8 b, Float8 c) { return { _mm256_fmadd_ps(a.v, b.v, c.v) }; }
+#else
+    inline Float8 MulAdd(Float8 a, Float8 b, Float8 c) { return { _mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v) }; }
+#endif
+
+    inline Float8 Min(Float8 a, Float8 b)  { return { _mm256_min_ps(a.v, b.v) }; }
+    inline Float8 Max(Float8 a, Float8 b)  { return { _mm256_max_ps(a.v, b.v) }; }
+    inline Float8 Sqrt(Float8 a)           { return { _mm256_sqrt_ps(a.v) }; }
+    inline Float8 Abs(Float8 a)            { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) }; }
+
+    inline Mask8 operator<(Float8 a, Float8 b)  { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+    inline Mask8 operator<=(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+    inline Mask8 operator>(Float8 a, Float8 b)  { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+    inline Mask8 operator>=(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+
+    inline Mask8 operator&(Mask8 a, Mask8 b) { return { _mm256_and_ps(a.v, b.v) }; }
+    inline Mask8 operator|(Mask8 a, Mask8 b) { return { _mm256_or_ps(a.v, b.v) }; }
+
+    // a onde a máscara está ligada, b caso contrário
+    inline Float8 Select(Mask8 m, Float8 a, Float8 b) { return { _mm256_blendv_ps(b.v, a.v, m.v) }; }
+    inline int    MoveMask(Mask8 m) { return _mm256_movemask_ps(m.v); }
+    inline Mask8  MaskFromBits(int bits)
+    {
+        return { _mm256_castsi256_ps(_mm256_setr_epi32(
+            -(bits & 1), -((bits >> 1) & 1), -((bits >> 2) & 1), -((bits >> 3) & 1),
+            -((bits >> 4) & 1), -((bits >> 5) & 1), -((bits >> 6) & 1), -((bits >> 7) & 1))) };
+    }
+
+#elif defined(CP_SIMD_SSE)
+
+    struct Mask8 { __m128 lo, hi; };
+    struct Float8 { __m128 lo, hi; };
+
+    inline Float8 Load(const float* p)          { return { _mm_load_ps(p), _mm_load_ps(p + 4) }; }
+    inline Float8 LoadUnaligned(const float* p) { return { _mm_loadu_ps(p), _mm_loadu_ps(p + 4) }; }
+    inline void   Store(float* p, Float8 a)     { _mm_store_ps(p, a.lo); _mm_store_ps(p + 4, a.hi); }
+    inline Float8 Set1(float s)                 { __m128 v = _mm_set1_ps(s); return { v, v }; }
+    inline Float8 Zero()                        { __m128 v = _mm_setzero_ps(); return { v, v }; }
+
+    inline Float8 operator+(Float8 a, Float8 b) { return { _mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi) }; }
+    inline Float8 operator-(Float8 a, Float8 b) { return { _mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi) }; }
+    inline Float8 operator*(Float8 a, Float8 b) { return { _mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi) }; }
+    inline Float8 operator/(Float8 a, Float8 b) { return { _mm_div_ps(a.lo, b.lo), _mm_div_ps(a.hi, b.hi) }; }
+    inline Float8 MulAdd(Float8 a, Float8 b, Float8 c) { return a * b + c; }
+
+    inline Float8 Min(Float8 a, Float8 b)  { return { _mm_min_ps(a.lo, b.lo), _mm_min_ps(a.hi, b.hi) }; }
+    inline Float8 Max(Float8 a, Float8 b)  { return { _mm_max_ps(a.lo, b.lo), _mm_max_ps(a.hi, b.hi) }; }
+    inline Float8 Sqrt(Float8 a)           { return { _mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi) }; }
+    inline Float8 Abs(Float8 a)
+    {
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        return { _mm_andnot_ps(sign, a.lo), _mm_andnot_ps(sign, a.hi) };
+    }
+
+    inline Mask8 operator<(Float8 a, Float8 b)  { return { _mm_cmplt_ps(a.lo, b.lo), _mm_cmplt_ps(a.hi, b.hi) }; }
+    inline Mask8 operator<=(Float8 a, Float8 b) { return { _mm_cmple_ps(a.lo, b.lo), _mm_cmple_ps(a.hi, b.hi) }; }
+    inline Mask8 operator>(Float8 a, Float8 b)  { return { _mm_cmpgt_ps(a.lo, b.lo), _mm_cmpgt_ps(a.hi, b.hi) }; }
+    inline Mask8 operator>=(Float8 a, Float8 b) { return { _mm_cmpge_ps(a.lo, b.lo), _mm_cmpge_ps(a.hi, b.hi) }; }
+
+    inline Mask8 operator&(Mask8 a, Mask8 b) { return { _mm_and_ps(a.lo, b.lo), _mm_and_ps(a.hi, b.hi) }; }
+    inline Mask8 operator|(Mask8 a, Mask8 b) { return { _mm_or_ps(a.lo, b.lo), _mm_or_ps(a.hi, b.hi) }; }
+
+    // SSE2 não tem blendv: (m & a) | (~m & b)
+    inline Float8 Select(Mask8 m, Float8 a, Float8 b)
+    {
+        return { _mm_or_ps(_mm_and_ps(m.lo, a.lo), _mm_andnot_ps(m.lo, b.lo)),
+                 _mm_or_ps(_mm_and_ps(m.hi, a.hi), _mm_andnot_ps(m.hi, b.hi)) };
+    }
+    inline int MoveMask(Mask8 m) { return _mm_movemask_ps(m.lo) | (_mm_movemask_ps(m.hi) << 4); }
+    inline Mask8 MaskFromBits(int bits)
+    {
+        return { _mm_castsi128_ps(_mm_setr_epi32(-(bits & 1), -((bits >> 1) & 1), -((bits >> 2) & 1), -((bits >> 3) & 1))),
+                 _mm_castsi128_ps(_mm_setr_epi32(-((bits >> 4) & 1), -((bits >> 5) & 1), -((bits >> 6) & 1), -((bits >> 7) & 1))) };
+    }
+
+#else
+
+    struct Mask8 { uint32_t bits; };
+    struct Float8 { float f[8]; };
+
+    inline Float8 Load(const float* p)          { Float8 r; for (int i = 0; i < 8; ++i) r.f[i] = p[i]; return r; }
+    inline Float8 LoadUnaligned(const float* p) { return Load(p); }
+    inline void   Store(float* p, Float8 a)     { for (int i = 0; i < 8; ++i) p[i] = a.f[i]; }
+    inline Float8 Set1(float s)                 { Float8 r; for (int i = 0; i < 8; ++i) r.f[i] = s; return r; }
+    inline Float8 Zero()                        { return Set1(0.0f); }
+
+    #define CP_SIMD_SCALAR_BINOP(expr) Float8 r; for (int i = 0; i < 8; ++i) r.f[i] = (expr); return r
+    inline Float8 operator+(Float8 a, Float8 b) { CP_SIMD_SCALAR_BINOP(a.f[i] + b.f[i]); }
+    inline Float8 operator-(Float8 a, Float8 b) { CP_SIMD_SCALAR_BINOP(a.f[i] - b.f[i]); }
+    inline Float8 operator*(Float8 a, Float8 b) { CP_SIMD_SCALAR_BINOP(a.f[i] * b.f[i]); }
+    inline Float8 operator/(Float8 a, Float8 b) { CP_SIMD_SCALAR_BINOP(a.f[i] / b.f[i]); }
+    inline Float8 Min(Float8 a, Float8 b)       { CP_SIMD_SCALAR_BINOP(a.f[i] < b.f[i] ? a.f[i] : b.f[i]); }
+    inline Float8 Max(Float8 a, Float8 b)       { CP_SIMD_SCALAR_BINOP(a.f[i] > b.f[i] ? a.f[i] : b.f[i]); }
+    inline Float8 Sqrt(Float8 a)                { CP_SIMD_SCALAR_BINOP(std::sqrt(a.f[i])); }
+    inline Float8 Abs(Float8 a)                 { CP_SIMD_SCALAR_BINOP(std::fabs(a.f[i])); }
+    #undef CP_SIMD_SCALAR_BINOP
+    inline Float8 MulAdd(Float8 a, Float8 b, Float8 c) { return a * b + c; }
+
+    #define CP_SIMD_SCALAR_CMP(op) Mask8 r{0}; for (int i = 0; i < 8; ++i) if (a.f[i] op b.f[i]) r.bits |= (1u << i); return r
+    inline Mask8 operator<(Float8 a, Float8 b)  { CP_SIMD_SCALAR_CMP(<); }
+    inline Mask8 operator<=(Float8 a, Float8 b) { CP_SIMD_SCALAR_CMP(<=); }
+    inline Mask8 operator>(Float8 a, Float8 b)  { CP_SIMD_SCALAR_CMP(>); }
+    inline Mask8 operator>=(Float8 a, Float8 b) { CP_SIMD_SCALAR_CMP(>=); }
+    #undef CP_SIMD_SCALAR_CMP
+
+    inline Mask8 operator&(Mask8 a, Mask8 b) { return { a.bits & b.bits }; }
+    inline Mask8 operator|(Mask8 a, Mask8 b) { return { a.bits | b.bits }; }
+
+    inline Float8 Select(Mask8 m, Float8 a, Float8 b)
+    {
+        Float8 r;
+        for (int i = 0; i < 8; ++i) r.f[i] = (m.bits & (1u << i)) ? a.f[i] : b.f[i];
+        return r;
+    }
+    inline int MoveMask(Mask8 m) { return static_cast<int>(m.bits); }
+    inline Mask8 MaskFromBits(int bits) { return { static_cast<uint32_t>(bits) & 0xFFu }; }
+
+#endif
+
+    // ---------------------------
+    // Helpers comuns (independentes do backend)
+    // ---------------------------
+    inline Float8 Dot3(Float8 ax, Float8 ay, Float8 az, Float8 bx, Float8 by, Float8 bz)
+    {
+        return MulAdd(ax, bx, MulAdd(ay, by, az * bz));
+    }
+
+    inline void Cross3(Float8 ax, Float8 ay, Float8 az,
+                       Float8 bx, Float8 by, Float8 bz,
+                       Float8& ox, Float8& oy, Float8& oz)
+    {
+        ox = ay * bz - az * by;
+        oy = az * bx - ax * bz;
+        oz = ax * by - ay * bx;
+    }
+
+    /// Máscara com as primeiras `count` lanes ligadas (para blocos parcialmente preenchidos).
+    inline int LaneMask(uint32_t count) { return count >= 8 ? 0xFF : static_cast<int>((1u << count) - 1u); }
+
+    } // inline namespace CP_SIMD_BACKEND
+
+} // namespace cp_api::simd
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cp_api {
+
+    namespace detail {
+
+        /// Épocas de leitura por thread, compartilhadas por todos os SnapshotCell.
+        class SnapshotEpochs {
+        public:
+            struct Slot;
+
+            /// Entra numa leitura (aninhável) e devolve a slot usada, para o LeaveRead.
+            static Slot* EnterRead();
+            static void LeaveRead(Slot* slot) noexcept;
+
+            /// Avança a época global; devolve a época que marca as versões retiradas agora.
+            static uint64_t Retire();
+
+            /// Menor época anunciada por uma leitura ativa (UINT64_MAX se nenhuma).
+            static uint64_t MinActive();
+        };
+
+    } // namespace detail
+
+    /**
+     * @brief Valor copy-on-write: leitores sem trava, versões antigas liberadas por época.
+     *
+     * Uma versão trocada é apagada quando acabam as leituras que começaram antes da troca.
+     */
+    template<typename T>
+    class SnapshotCell {
+    public:
+        class ReadGuard {
+        public:
+            ReadGuard(ReadGuard&& other) noexcept
+                : m_cell(std::exchange(other.m_cell, nullptr)), m_slot(other.m_slot), m_value(other.m_value) {}
+            ReadGuard(const ReadGuard&) = delete;
+            ReadGuard& operator=(const ReadGuard&) = delete;
+            ReadGuard& operator=(ReadGuard&&) = delete;
+
+            ~ReadGuard() { if (m_cell) m_cell->endRead(m_slot); }
+
+            const T& operator*() const { return *m_value; }
+            const T* operator->() const { return m_value; }
+            const T* Get() const { return m_value; }
+
+        private:
+            friend class SnapshotCell;
+            ReadGuard(const SnapshotCell* cell, detail::SnapshotEpochs::Slot* slot, const T* value)
+                : m_cell(cell), m_slot(slot), m_value(value) {}
+
+            const SnapshotCell* m_cell;
+            detail::SnapshotEpochs::Slot* m_slot;
+            const T* m_value;
+        };
+
+        SnapshotCell() : SnapshotCell(std::make_unique<T>()) {}
+        explicit SnapshotCell(std::unique_ptr<T> initial) : m_current(initial.release()) {}
+
+        ~SnapshotCell() {
+            delete m_current.load(std::memory_order_relaxed);
+            for (const Retired& old : m_retired) delete old.value;
+        }
+
+        SnapshotCell(const SnapshotCell&) = delete;
+        SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+        ReadGuard Read() const {
+            detail::SnapshotEpochs::Slot* slot = detail::SnapshotEpochs::EnterRead();
+            return ReadGuard(this, slot, m_current.load(std::memory_order_seq_cst));
+        }
+
+        /// Aplica `mutate(T&)` numa cópia e publica (true); se `mutate` devolver false, descarta a cópia.
+        template<typename Mutate>
+        bool Update(Mutate&& mutate) {
+            std::lock_guard lock(m_writeMutex);
+            auto next = std::make_unique<T>(*m_current.load(std::memory_order_relaxed));
+
+            if constexpr (std::is_same_v<std::invoke_result_t<Mutate&, T&>, bool>) {
+                if (!mutate(*next)) return false;
+            } else {
+                mutate(*next);
+            }
+
+            T* old = m_current.exchange(next.release(), std::memory_order_seq_cst);
+            const uint64_t epoch = detail::SnapshotEpochs::Retire();
+            std::lock_guard retireLock(m_retireMutex);
+            m_retired.push_back({ epoch, old });
+            m_hasRetired.store(true, std::memory_order_release);
+            reclaimLocked();
+            return true;
+        }
+
+        /// Versões antigas ainda esperando leitores saírem.
+        size_t GetRetiredCount() const {
+            std::lock_guard lock(m_retireMutex);
+            return m_retired.size();
+        }
+
+    private:
+        struct Retired {
+            uint64_t epoch;
+            T* value;
+        };
+
+        void endRead(detail::SnapshotEpochs::Slot* slot) const {
+            detail::SnapshotEpochs::LeaveRead(slot);
+            if (m_hasRetired.load(std::memory_order_relaxed)) {
+                // nunca bloqueia o leitor: se um escritor está mexendo, ele mesmo recolhe
+                std::unique_lock lock(m_retireMutex, std::try_to_lock);
+                if (lock) reclaimLocked();
+            }
+        }
+
+        // Só com m_retireMutex. Versão retirada na época e: livre se toda leitura ativa anunciou
+        // uma época maior (começou depois da troca e não pode tê-la visto).
+        void reclaimLocked() const {
+            if (m_retired.empty()) return;
+            const uint64_t minActive = detail::SnapshotEpochs::MinActive();
+
+            size_t kept = 0;
+            for (const Retired& old : m_retired) {
+                if (old.epoch < minActive) delete old.value;
+                else m_retired[kept++] = old;
+            }
+            m_retired.resize(kept);
+            m_hasRetired.store(kept != 0, std::memory_order_relaxed);
+        }
+
+        std::atomic<T*> m_current;
+        mutable std::atomic<bool> m_hasRetired{ false };
+
+        std::mutex m_writeMutex;
+        mutable std::mutex m_retireMutex;
+        mutable std::vector<Retired> m_retired;
+    };
+
+} // namespace cp_api
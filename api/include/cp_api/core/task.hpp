@@ -0,0 +1,364 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cp_api/core/threadPool.hpp"
+
+namespace cp_api {
+
+    template<typename T = void>
+    class Task;
+
+    namespace detail {
+
+        /**
+         * @brief Pooled allocator for coroutine frames.
+         *
+         * Frames are rounded up to power-of-two size classes (64 B .. 4 KiB) and recycled through
+         * per-thread free lists, spilling to a shared list when a thread caches too many (frames
+         * are often freed on a different worker than the one that allocated them). Bigger frames
+         * go straight to ::operator new.
+         */
+        class CoroutineFrameAllocator {
+        public:
+            static void* Allocate(size_t size);
+            static void Deallocate(void* ptr, size_t size) noexcept;
+        };
+
+        struct TaskPromiseBase {
+            std::coroutine_handle<> continuation;
+            std::exception_ptr exception;
+
+            static void* operator new(size_t size) { return CoroutineFrameAllocator::Allocate(size); }
+            static void operator delete(void* ptr, size_t size) noexcept { CoroutineFrameAllocator::Deallocate(ptr, size); }
+
+            // lazy: só começa quando alguém faz co_await (ou SyncWait/Spawn)
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            // transferência simétrica para quem esperava: sem recursão na pilha em cadeias longas
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+
+                template<typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+                    std::coroutine_handle<> next = handle.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+
+                void await_resume() noexcept {}
+            };
+            FinalAwaiter final_suspend() noexcept { return {}; }
+
+            void unhandled_exception() noexcept { exception = std::current_exception(); }
+        };
+
+        template<typename T>
+        struct TaskPromise : TaskPromiseBase {
+            std::optional<T> value;
+
+            Task<T> get_return_object() noexcept;
+
+            template<typename U>
+            void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+
+            T TakeResult() {
+                if (exception) std::rethrow_exception(exception);
+                return std::move(*value);
+            }
+        };
+
+        template<>
+        struct TaskPromise<void> : TaskPromiseBase {
+            Task<void> get_return_object() noexcept;
+
+            void return_void() noexcept {}
+
+            void TakeResult() {
+                if (exception) std::rethrow_exception(exception);
+            }
+        };
+
+        /**
+         * @brief Pool task that resumes a suspended coroutine.
+         *
+         * If the pool discards it at Shutdown, the destructor still resumes the coroutine with
+         * `*cancelled` set, so its await_resume throws and the frames unwind through their owners
+         * (Task, Spawn, SyncWait) back to the CoroutineFrameAllocator instead of leaking. Destroying
+         * the handle here would free a frame that a Task may still own.
+         */
+        /// Retoma com o await marcado como cancelado (o await_resume lança).
+        inline void ResumeCancelled(std::coroutine_handle<> handle, bool* cancelled) {
+            *cancelled = true;
+            handle.resume();
+        }
+
+        class PoolResume {
+        public:
+            PoolResume(std::coroutine_handle<> handle, bool* cancelled) noexcept
+                : m_handle(handle), m_cancelled(cancelled) {}
+            PoolResume(PoolResume&& other) noexcept
+                : m_handle(std::exchange(other.m_handle, {})), m_cancelled(other.m_cancelled) {}
+            PoolResume(const PoolResume&) = delete;
+            PoolResume& operator=(const PoolResume&) = delete;
+            PoolResume& operator=(PoolResume&&) = delete;
+
+            ~PoolResume() {
+                if (m_handle)
+                    ResumeCancelled(std::exchange(m_handle, {}), m_cancelled);
+            }
+
+            void operator()() { std::exchange(m_handle, {}).resume(); }
+
+            /// Desiste sem retomar (Dispatch falhou dentro de await_suspend: a exceção já retoma).
+            void Release() noexcept { m_handle = {}; }
+
+        private:
+            std::coroutine_handle<> m_handle;
+            bool* m_cancelled;
+        };
+
+        [[noreturn]] void ThrowResumeCancelled();
+
+        /// Corrotina sem dono: começa na hora e libera o próprio frame ao terminar.
+        struct DetachedTask {
+            struct promise_type {
+                static void* operator new(size_t size) { return CoroutineFrameAllocator::Allocate(size); }
+                static void operator delete(void* ptr, size_t size) noexcept { CoroutineFrameAllocator::Deallocate(ptr, size); }
+
+                DetachedTask get_return_object() noexcept { return {}; }
+                std::suspend_never initial_suspend() noexcept { return {}; }
+                std::suspend_never final_suspend() noexcept { return {}; }
+                void return_void() noexcept {}
+                void unhandled_exception() noexcept { std::terminate(); }
+            };
+        };
+
+    } // namespace detail
+
+    /**
+     * @brief Lazily-started coroutine producing a T.
+     *
+     * The body runs when the task is awaited (`co_await std::move(task)` or `co_await task`), on the
+     * awaiting thread; it moves to the ThreadPool with `co_await ScheduleOn(pool)`. Completion
+     * resumes the awaiter by symmetric transfer and exceptions propagate through co_await.
+     * Non-coroutine code starts tasks with SyncWait (blocks, helping the pool) or Spawn (detached).
+     *
+     * @code
+     *   Task<Mesh> LoadMesh(ThreadPool& pool, std::filesystem::path path) {
+     *       auto [owner, bytes] = co_await ReadBytesAsync(pool, path);   // leitura em BACKGROUND
+     *       Mesh mesh = ParseMesh(bytes);                                 // de volta em NORMAL
+     *       co_await frames.NextFrame();                                  // espera a virada do frame
+     *       co_return mesh;
+     *   }
+     * @endcode
+     */
+    template<typename T>
+    class [[nodiscard]] Task {
+    public:
+        using promise_type = detail::TaskPromise<T>;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        Task() noexcept = default;
+        explicit Task(Handle handle) noexcept : m_handle(handle) {}
+        ~Task() { if (m_handle) m_handle.destroy(); }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                if (m_handle) m_handle.destroy();
+                m_handle = std::exchange(other.m_handle, {});
+            }
+            return *this;
+        }
+
+        bool IsValid() const noexcept { return static_cast<bool>(m_handle); }
+        bool IsDone() const noexcept { return !m_handle || m_handle.done(); }
+
+        struct Awaiter {
+            Handle handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle; // transferência simétrica: inicia a tarefa sem crescer a pilha
+            }
+
+            T await_resume() { return handle.promise().TakeResult(); }
+        };
+
+        Awaiter operator co_await() & noexcept { return Awaiter{ m_handle }; }
+        Awaiter operator co_await() && noexcept { return Awaiter{ m_handle }; }
+
+    private:
+        template<typename U>
+        friend U SyncWait(ThreadPool& pool, Task<U> task);
+
+        Handle m_handle;
+    };
+
+    namespace detail {
+
+        template<typename T>
+        Task<T> TaskPromise<T>::get_return_object() noexcept {
+            return Task<T>{ std::coroutine_handle<TaskPromise<T>>::from_promise(*this) };
+        }
+
+        inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+            return Task<void>{ std::coroutine_handle<TaskPromise<void>>::from_promise(*this) };
+        }
+
+    } // namespace detail
+
+    // ---------------------------
+    // Awaitables
+    // ---------------------------
+
+    /**
+     * @brief co_await ScheduleOn(pool): continua a corrotina em um worker do pool.
+     * Lança std::runtime_error se o pool descartar a retomada no Shutdown.
+     */
+    struct ScheduleOn {
+        ThreadPool& pool;
+        TaskPriority priority = TaskPriority::NORMAL;
+        bool cancelled = false;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) {
+            detail::PoolResume resume(handle, &cancelled);
+            try {
+                pool.Dispatch(priority, std::move(resume));
+            } catch (...) {
+                resume.Release();
+                throw;
+            }
+        }
+        void await_resume() const { if (cancelled) detail::ThrowResumeCancelled(); }
+    };
+
+    /**
+     * @brief Resumes coroutines at the next frame boundary.
+     *
+     * `co_await frames.NextFrame()` parks the coroutine until the owner calls AdvanceFrame()
+     * (once per frame, from the main loop), which dispatches every parked coroutine to the pool.
+     * Like ScheduleOn, the await throws if the pool discards the resume at Shutdown, if the pool
+     * is already stopped at AdvanceFrame, or if the scheduler is destroyed first.
+     */
+    class FrameScheduler {
+    public:
+        explicit FrameScheduler(ThreadPool& pool) : m_pool(pool) {}
+        /// Quem ainda espera é retomado com o erro de cancelamento (como no Shutdown do pool).
+        ~FrameScheduler();
+
+        FrameScheduler(const FrameScheduler&) = delete;
+        FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+        struct Awaiter {
+            FrameScheduler& scheduler;
+            TaskPriority priority;
+            bool cancelled = false;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { scheduler.park(handle, priority, &cancelled); }
+            void await_resume() const { if (cancelled) detail::ThrowResumeCancelled(); }
+        };
+
+        Awaiter NextFrame(TaskPriority priority = TaskPriority::NORMAL) { return Awaiter{ *this, priority }; }
+
+        /// Chamado uma vez por frame: libera quem esperava pela virada.
+        void AdvanceFrame();
+
+        uint64_t GetFrameIndex() const { return m_frameIndex.load(std::memory_order_acquire); }
+        size_t GetWaitingCount() const;
+
+    private:
+        struct Parked {
+            std::coroutine_handle<> handle;
+            TaskPriority priority;
+            bool* cancelled;
+        };
+
+        void park(std::coroutine_handle<> handle, TaskPriority priority, bool* cancelled);
+
+        ThreadPool& m_pool;
+        mutable std::mutex m_mutex;
+        std::vector<Parked> m_parked;
+        std::vector<Parked> m_resuming; // reaproveitado entre frames
+        std::atomic<uint64_t> m_frameIndex{ 0 };
+    };
+
+    /**
+     * @brief Reads a whole file on a BACKGROUND worker, then resumes on the pool at `resumeOn`.
+     * Same result as filesystem::ReadBytesAuto (owner + view; large files are memory-mapped).
+     */
+    Task<std::pair<std::shared_ptr<uint8_t[]>, std::span<const uint8_t>>>
+    ReadBytesAsync(ThreadPool& pool, std::filesystem::path path, TaskPriority resumeOn = TaskPriority::NORMAL);
+
+    /// Inicia a tarefa sem esperar; exceções não tratadas são logadas.
+    void Spawn(ThreadPool& pool, Task<void> task, TaskPriority priority = TaskPriority::NORMAL);
+
+    /**
+     * @brief Run `task` to completion from non-coroutine code and return its result.
+     * The task starts on the calling thread; while it is suspended the caller executes pool work
+     * (ThreadPool::WaitUntil), so this is safe from a worker or a MainThreadScope. Throws
+     * std::runtime_error if the pool shuts down first; the unfinished frame is then left to the
+     * detached coroutine driving it, never destroyed under a FrameScheduler or pool task.
+     */
+    template<typename T>
+    T SyncWait(ThreadPool& pool, Task<T> task)
+    {
+        // dividido com `run`: se o pool parar antes do fim, a tarefa fica com ele
+        struct State {
+            Task<T> task;
+            std::atomic<int> status{ 0 }; // 0 rodando, 1 terminou, 2 abandonada por quem esperava
+        };
+
+        // não consome o resultado: TakeResult roda aqui, depois que a tarefa terminou
+        struct Observe {
+            typename Task<T>::Handle handle;
+            bool await_ready() const noexcept { return handle.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            void await_resume() const noexcept {}
+        };
+
+        auto run = [](std::shared_ptr<State> state, Observe observe, ThreadPool& pool) -> detail::DetachedTask {
+            co_await observe;
+            int running = 0;
+            if (state->status.compare_exchange_strong(running, 1, std::memory_order_acq_rel))
+                pool.NotifyWaiters(); // quem chama ainda espera; abandonada, nem toca o pool
+        };
+
+        if (!task.m_handle)
+            throw std::logic_error("SyncWait on an empty Task");
+
+        auto state = std::make_shared<State>();
+        state->task = std::move(task);
+        const typename Task<T>::Handle handle = state->task.m_handle;
+
+        run(state, Observe{ handle }, pool);
+        pool.WaitUntil([&state] { return state->status.load(std::memory_order_acquire) == 1; });
+
+        // WaitUntil desiste no Shutdown: tarefa parada (ex.: no FrameScheduler) não tem resultado
+        int running = 0;
+        if (state->status.compare_exchange_strong(running, 2, std::memory_order_acq_rel))
+            detail::ThrowResumeCancelled();
+        return handle.promise().TakeResult();
+    }
+
+} // namespace cp_api
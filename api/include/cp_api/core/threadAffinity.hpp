@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cp_api {
+
+    /**
+     * @brief CPUs lógicas do processo por núcleo físico (sysfs / GetLogicalProcessorInformationEx).
+     * Sem topologia, cada CPU lógica conta como um núcleo.
+     */
+    class CpuTopology {
+    public:
+        struct LogicalCpu {
+            uint32_t id = 0;       // número do SO (bit da máscara de afinidade)
+            uint32_t core = 0;     // índice do núcleo físico em `cores`
+            uint32_t smtIndex = 0; // 0 = primeira thread do núcleo, 1 = irmã HT, ...
+        };
+
+        static const CpuTopology& Get();
+
+        const std::vector<LogicalCpu>& GetLogicalCpus() const { return m_cpus; }
+        size_t GetLogicalCount() const { return m_cpus.size(); }
+        size_t GetPhysicalCount() const { return m_cores.size(); }
+
+        /// CPUs lógicas do núcleo físico `core`.
+        const std::vector<uint32_t>& GetCoreCpus(size_t core) const { return m_cores[core]; }
+
+        /// CPUs em ordem de uso, pulando `skipCores` núcleos; com preferPhysical, irmãs SMT por último.
+        std::vector<uint32_t> PlacementOrder(size_t skipCores, bool preferPhysical) const;
+
+    private:
+        CpuTopology();
+
+        std::vector<LogicalCpu> m_cpus;
+        std::vector<std::vector<uint32_t>> m_cores; // ids por núcleo físico
+    };
+
+    /// Restringe a thread atual às CPUs lógicas dadas; false se o SO recusar (ou não suportado).
+    bool SetCurrentThreadAffinity(std::span<const uint32_t> cpus);
+
+    /// Nome visível em profilers/debuggers (Linux corta em 15 caracteres).
+    void SetCurrentThreadName(const std::string& name);
+
+} // namespace cp_api
@@ -1,23 +1,100 @@
 #pragma once
 
 #include <vector>
-#include <deque>
 #include <thread>
-#include <mutex>
-#include <condition_variable>
 #include <future>
 #include <functional>
 #include <atomic>
-#include <random>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <chrono>
+#include <string>
+
+#include "cp_api/core/workStealingDeque.hpp"
+#include "cp_api/core/mpmcQueue.hpp"
+#include "cp_api/core/eventCount.hpp"
+#include "cp_api/core/threadPoolStats.hpp"
+#include "cp_api/core/frameArena.hpp"
 
 namespace cp_api {
 
-enum class TaskPriority { HIGH, NORMAL, LOW };
+/**
+ * @brief HIGH > NORMAL > LOW são trabalho de frame (LOW envelhece, não passa fome). BACKGROUND só
+ * roda sem trabalho de frame visível, em até GetBackgroundWorkerLimit() workers por vez.
+ */
+enum class TaskPriority { HIGH, NORMAL, LOW, BACKGROUND };
+
+/// Contador de junção de Dispatch/DispatchBatch (Wait volta em zero); vive mais que as tarefas.
+class TaskCounter {
+public:
+    TaskCounter() = default;
+    TaskCounter(const TaskCounter&) = delete;
+    TaskCounter& operator=(const TaskCounter&) = delete;
+
+    int64_t Pending() const { return m_pending.load(std::memory_order_acquire); }
+    bool IsDone() const { return Pending() == 0; }
+
+private:
+    friend class ThreadPool;
+    std::atomic<int64_t> m_pending{ 0 };
+};
+
+/// Posicionamento: os primeiros `reservedCores` núcleos físicos ficam para main/render (GetReservedCpus).
+struct ThreadPoolConfig {
+    size_t workerCount = 0;          // 0: um por núcleo livre (ou por CPU lógica sem preferPhysical)
+    size_t backgroundWorkers = 0;    // 0: max(1, workerCount / 4)
+    bool mainThreadWorker = false;   // índice 0 para MainThreadScope
+    size_t reservedCores = 0;        // núcleos físicos fora do pool (main/render)
+    bool pinWorkers = false;         // fixa cada worker em uma CPU lógica (pthread_setaffinity_np)
+    bool preferPhysicalCores = true; // SMT: irmãs HT só depois de todos os núcleos terem um worker
+    std::string threadNamePrefix = "cp-worker";
+};
 
+/**
+ * @brief Pool de threads com roubo de trabalho.
+ *
+ * Um deque Chase–Lev por worker e prioridade; de fora, filas MPMC de injeção. Cada nível inteiro
+ * (lane própria, injeção, roubo) antes do seguinte. BACKGROUND: fila única, até `backgroundWorkers`
+ * por vez, nunca pega por Wait().
+ *
+ * Sem trabalho, o worker gira um pouco e estaciona num EventCount compartilhado; quem acorda e
+ * ainda vê tarefas acorda mais um.
+ *
+ * Tarefas em slots fixos reciclados por worker: callables até TaskSlot::InlineSize não tocam o heap.
+ *
+ * Dentro de tarefa, nunca `future.get()`: use WaitAndHelp. `mainThreadWorker` reserva o worker 0
+ * para uma thread externa (MainThreadScope).
+ *
+ * Instrumentação opt-in (SetInstrumentation): contadores por worker, lidos por SnapshotStats.
+ */
 class ThreadPool {
 public:
-    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+    /**
+     * @param threadCount Threads criadas (no mínimo 1).
+     * @param backgroundWorkers Máximo de workers em BACKGROUND; 0 = max(1, threadCount / 4).
+     * @param mainThreadWorker Reserva o worker 0 para MainThreadScope (as threads viram 1..threadCount).
+     */
+    explicit ThreadPool(size_t threadCount, size_t backgroundWorkers = 0, bool mainThreadWorker = false);
+
+    explicit ThreadPool(const ThreadPoolConfig& config = {});
+
+    /// A thread vira o worker 0 enquanto o escopo vive (um por vez); ao sair, roda o que ficou nas lanes.
+    class MainThreadScope {
+    public:
+        explicit MainThreadScope(ThreadPool& pool) : m_pool(pool) { m_pool.AttachMainThread(); }
+        ~MainThreadScope() { m_pool.DetachMainThread(); }
+
+        MainThreadScope(const MainThreadScope&) = delete;
+        MainThreadScope& operator=(const MainThreadScope&) = delete;
+
+    private:
+        ThreadPool& m_pool;
+    };
     ~ThreadPool();
 
     ThreadPool(const ThreadPool&) = delete;
@@ -29,49 +106,349 @@ public:
     auto Submit(TaskPriority priority, Func&& f, Args&&... args)
         -> std::future<decltype(f(args...))>;
 
+    /// Envio sem future nem estado compartilhado (continuações; a conclusão vai por contadores).
+    template<typename Func>
+    void Dispatch(TaskPriority priority, Func&& f);
+
+    /// Igual a Dispatch, mantendo `counter` incrementado até a tarefa terminar.
+    template<typename Func>
+    void Dispatch(TaskPriority priority, TaskCounter& counter, Func&& f);
+
+    /// `count` tarefas f(i) com uma operação de fila; `f` é copiado em cada slot (capture por referência).
+    template<typename Func>
+    void DispatchBatch(TaskPriority priority, size_t count, Func&& f);
+
+    template<typename Func>
+    void DispatchBatch(TaskPriority priority, TaskCounter& counter, size_t count, Func&& f);
+
+    /// Espera `counter` zerar executando tarefas (seguro dentro de um worker).
+    void Wait(TaskCounter& counter);
+    void WaitAndHelp(TaskCounter& counter) { Wait(counter); }
+
+    /// future.get() que executa tarefas (nunca BACKGROUND) enquanto espera; relança a exceção.
+    template<typename T>
+    T WaitAndHelp(std::future<T>& future);
+
+    /// Executa tarefas (nunca BACKGROUND) até done(); quem o torna true fora do pool chama NotifyWaiters().
+    template<typename Done>
+    void WaitUntil(Done&& done) { helpUntil(done); }
+
+    /// Acorda quem está em Wait/WaitAndHelp/WaitUntil para reavaliar a condição.
+    void NotifyWaiters() { m_joined.NotifyAll(); }
+
     void Shutdown();
 
+    /// Número de índices de worker (threads do pool + o slot 0 da thread principal, se houver).
+    size_t GetWorkerCount() const { return m_workerData.size(); }
+    bool HasMainThreadWorker() const { return m_mainThreadWorker; }
+
+    /**
+     * @brief End of frame: every worker's FrameArena (and worker 0's, used by MainThreadScope)
+     * rewinds at its next allocation. Call after all frame work has been joined.
+     */
+    void ResetFrameArenas() { m_frameEpoch.fetch_add(1, std::memory_order_relaxed); }
+
+    /// CPUs lógicas dos núcleos reservados (vazio sem reservedCores): afinidade da main/render thread.
+    const std::vector<uint32_t>& GetReservedCpus() const { return m_reservedCpus; }
+
+    /// Limite de workers executando tarefas BACKGROUND simultaneamente (mínimo 1).
+    void SetBackgroundWorkerLimit(size_t limit);
+    size_t GetBackgroundWorkerLimit() const { return m_backgroundLimit.load(std::memory_order_relaxed); }
+
+    /// Índice do worker da thread atual neste pool, ou SIZE_MAX fora dele.
+    size_t CurrentWorkerIndex() const;
+
+    /// Dica para divisão preguiçosa: no worker, lanes próprias vazias; fora, menos tarefas que workers.
+    bool HasIdleCapacity() const;
+
+    // ---------------------------
+    // Instrumentação (opt-in)
+    // ---------------------------
+    void SetInstrumentation(bool enabled) { m_instrumented.store(enabled, std::memory_order_relaxed); }
+    bool IsInstrumentationEnabled() const { return m_instrumented.load(std::memory_order_relaxed); }
+
+    /// Contadores desde o último reset; com reset=true, uma chamada por frame dá números por frame.
+    ThreadPoolStats SnapshotStats(bool reset = true);
+    void ResetStats() { SnapshotStats(true); }
+
 private:
+    // ---------------------------
+    // Slot de tarefa com armazenamento inline
+    // ---------------------------
+    struct alignas(64) TaskSlot {
+        static constexpr size_t InlineSize = 96;
+        static constexpr uint32_t ExternalOwner = UINT32_MAX;
+
+        void (*op)(TaskSlot&, bool run) = nullptr; // executa (run) e destrói o callable
+        TaskCounter* counter = nullptr;
+        union {
+            TaskSlot* next = nullptr;               // free lists
+            uint64_t enqueueNs;                     // enquanto enfileirada (instrumentação); 0 = sem medição
+        };
+        uint32_t owner = ExternalOwner;             // worker dono do slot
+        TaskPriority priority = TaskPriority::NORMAL;
+        alignas(16) unsigned char storage[InlineSize];
+
+        template<typename Func>
+        void Bind(Func&& f);
+    };
+    static_assert(sizeof(TaskSlot) == 128, "TaskSlot should span exactly two cache lines");
+
+    static constexpr size_t LaneCount = 3; // HIGH, NORMAL, LOW (BACKGROUND tem fila própria)
+
+    // contadores de instrumentação: escritos só pela thread dona (load + store), lidos por SnapshotStats;
+    // o bloco das threads externas é compartilhado e usa fetch_add
+    struct alignas(64) Counters {
+        std::atomic<uint64_t> busyNs{ 0 };
+        std::atomic<uint64_t> tasksRun{ 0 };
+        std::atomic<uint64_t> stealsOk{ 0 };
+        std::atomic<uint64_t> stealsFailed{ 0 };
+        std::atomic<uint32_t> maxQueueDepth{ 0 };
+        std::atomic<uint64_t> latency[ThreadPoolStats::LatencyBucketCount] = {};
+    };
+
+    // valores em SnapshotStats(reset) anterior; a diferença é o intervalo
+    struct CountersBaseline {
+        uint64_t busyNs = 0, tasksRun = 0, stealsOk = 0, stealsFailed = 0;
+        uint64_t latency[ThreadPoolStats::LatencyBucketCount] = {};
+    };
+
+    struct Worker {
+        WorkStealingDeque<TaskSlot*> lanes[LaneCount];
+        TaskSlot* freeList = nullptr;                             // só o dono
+        uint32_t lookups = 0;                                     // só o dono (aging)
+        alignas(64) std::atomic<TaskSlot*> remoteFree{ nullptr }; // devolvidos por outras threads
+        Counters stats;
+        FrameArena arena;                                         // só o dono; FrameArena::Current()
+    };
+
+    static constexpr size_t SlotChunkSize = 256;
+
+    TaskSlot* AllocateSlot();
+    void FreeSlot(TaskSlot* slot);
+    TaskSlot* AllocateChunk(uint32_t owner);
+
+    template<typename Func>
+    void dispatchBatch(TaskPriority priority, TaskCounter* counter, size_t count, Func& f);
+
+    void Enqueue(TaskSlot* task, TaskPriority priority);
+    void EnqueueBatch(TaskSlot* const* tasks, size_t count, TaskPriority priority);
+    void Signal(size_t count);
+    TaskSlot* FindTask(size_t index, bool allowBackground);
+    TaskSlot* FindInLane(size_t index, size_t lane);
+    TaskSlot* FindBackground();
+    bool OwnLanesEmpty(size_t index) const;
+
+    /// Executa tarefas até done() ficar verdadeiro; estaciona em m_joined quando não há o que roubar.
+    // stopOnShutdown: desiste quando o pool parou e não há o que rodar (done() pode nunca ficar true)
+    template<typename Done>
+    void helpUntil(Done&& done, bool stopOnShutdown = true);
+    bool shutdownReached(size_t self) const;
+
+    void Start(const ThreadPoolConfig& config);
+    void AttachMainThread();
+    void DetachMainThread();
+
+    Counters& StatsFor(size_t index) { return index != SIZE_MAX ? m_workerData[index]->stats : m_externalStats; }
+    static void AddCounter(std::atomic<uint64_t>& counter, uint64_t value, bool shared) {
+        if(shared) counter.fetch_add(value, std::memory_order_relaxed);
+        else counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+    void RunTask(TaskSlot* task);
+    void DiscardTask(TaskSlot* task);
     void WorkerLoop(size_t index);
 
+    void CheckRunning() const {
+        if(!m_running.load(std::memory_order_acquire))
+            throw std::runtime_error("ThreadPool is shut down");
+    }
+
 private:
-    std::vector<std::deque<std::function<void()>>> m_queues;
-    std::vector<std::mutex> m_mutexes;
-    std::vector<std::condition_variable> m_conditions;
+    std::vector<std::unique_ptr<Worker>> m_workerData;
+    std::unique_ptr<MPMCQueue<TaskSlot*>> m_injection[LaneCount]; // um por prioridade de frame
     std::vector<std::thread> m_workers;
     std::atomic_bool m_running;
+    std::atomic_bool m_stopped{ false }; // Shutdown terminou: workers parados, sobras descartadas
+
+    alignas(64) std::atomic<uint64_t> m_frameEpoch{ 0 }; // ResetFrameArenas
+
+    // posicionamento
+    std::vector<int64_t> m_workerCpus; // CPU lógica por índice de worker, -1 = sem afinidade
+    std::vector<uint32_t> m_reservedCpus;
+    std::string m_threadNamePrefix;
+
+    // worker 0 emprestado pela thread principal (MainThreadScope)
+    bool m_mainThreadWorker = false;
+    std::atomic_bool m_mainAttached{ false };
 
-    std::mt19937 m_rng{ std::random_device{}() };
-    std::uniform_int_distribution<size_t> m_dist;
+    // BACKGROUND: fila compartilhada, no máximo m_backgroundLimit workers nela
+    std::unique_ptr<MPMCQueue<TaskSlot*>> m_background;
+    std::atomic<size_t> m_backgroundLimit{ 1 };
+    alignas(64) std::atomic<size_t> m_backgroundActive{ 0 };
+
+    // a cada N buscas o worker olha LOW antes de HIGH/NORMAL: LOW não passa fome
+    static constexpr uint32_t LowAgingInterval = 32;
+
+    // workers ociosos
+    static constexpr int SpinRounds = 64;
+    alignas(64) std::atomic<int64_t> m_queuedTasks{ 0 };
+    std::atomic<int64_t> m_queuedByLane[LaneCount + 1] = {}; // evita varrer lanes vazias
+    EventCount m_idle;
+    EventCount m_joined; // acorda quem está em Wait: contador zerou ou chegou trabalho
+
+    // instrumentação
+    std::atomic_bool m_instrumented{ false };
+    Counters m_externalStats;
+    std::mutex m_statsMutex;
+    std::vector<CountersBaseline> m_statsBaseline; // m_workerData.size() + 1 (externo por último)
+    uint64_t m_statsBaselineNs = 0;
+
+    // memória dos slots: blocos fixos, liberados só no destrutor
+    std::mutex m_chunkMutex;
+    std::vector<std::unique_ptr<TaskSlot[]>> m_slotChunks;
+    TaskSlot* m_externalFree = nullptr; // slots de threads fora do pool (sob m_chunkMutex)
 };
 
 // ---------------- Template Implementation ----------------
 
+template<typename Func>
+void ThreadPool::TaskSlot::Bind(Func&& f)
+{
+    using Fn = std::decay_t<Func>;
+
+    if constexpr (sizeof(Fn) <= InlineSize && alignof(Fn) <= 16) {
+        ::new (static_cast<void*>(storage)) Fn(std::forward<Func>(f));
+        op = [](TaskSlot& slot, bool run) {
+            Fn* fn = std::launder(reinterpret_cast<Fn*>(slot.storage));
+            struct Destroy { Fn* fn; ~Destroy() { fn->~Fn(); } } guard{ fn };
+            if(run) (*fn)();
+        };
+    } else {
+        // callable grande demais para o slot: cai para o heap
+        Fn* heap = new Fn(std::forward<Func>(f));
+        std::memcpy(storage, &heap, sizeof(heap));
+        op = [](TaskSlot& slot, bool run) {
+            Fn* fn;
+            std::memcpy(&fn, slot.storage, sizeof(fn));
+            std::unique_ptr<Fn> owner(fn);
+            if(run) (*fn)();
+        };
+    }
+}
+
 template<typename Func, typename... Args>
 auto ThreadPool::Submit(TaskPriority priority, Func&& f, Args&&... args)
     -> std::future<decltype(f(args...))>
 {
     using ReturnType = decltype(f(args...));
 
-    if (!m_running.load(std::memory_order_acquire))
-        throw std::runtime_error("ThreadPool is shut down");
+    CheckRunning();
 
     auto task = std::make_shared<std::packaged_task<ReturnType()>>(
         std::bind(std::forward<Func>(f), std::forward<Args>(args)...)
     );
     std::future<ReturnType> future = task->get_future();
 
-    size_t idx = m_dist(m_rng);
-    {
-        std::lock_guard<std::mutex> lock(m_mutexes[idx]);
-        if(priority == TaskPriority::HIGH)
-            m_queues[idx].emplace_front([task]{ (*task)(); });
-        else
-            m_queues[idx].emplace_back([task]{ (*task)(); });
+    TaskSlot* slot = AllocateSlot();
+    slot->Bind([this, task = std::move(task)]{
+        (*task)();
+        m_joined.NotifyAll(); // quem está em WaitAndHelp(future) não vê contador; acorda aqui
+    });
+    Enqueue(slot, priority);
+    return future;
+}
+
+template<typename T>
+T ThreadPool::WaitAndHelp(std::future<T>& future)
+{
+    helpUntil([&future] { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+    return future.get();
+}
+
+template<typename Done>
+void ThreadPool::helpUntil(Done&& done, bool stopOnShutdown)
+{
+    const size_t self = CurrentWorkerIndex();
+
+    while(!done()) {
+        if(TaskSlot* task = FindTask(self, false)) {
+            RunTask(task);
+            continue;
+        }
+        if(stopOnShutdown && shutdownReached(self))
+            return;
+
+        EventCount::Key key = m_joined.PrepareWait();
+        if(done()) {
+            m_joined.CancelWait();
+            break;
+        }
+        if(TaskSlot* task = FindTask(self, false)) {
+            m_joined.CancelWait();
+            RunTask(task);
+            continue;
+        }
+        if(stopOnShutdown && shutdownReached(self)) {
+            m_joined.CancelWait();
+            return;
+        }
+        m_joined.CommitWait(key);
     }
+}
 
-    m_conditions[idx].notify_one();
-    return future;
+template<typename Func>
+void ThreadPool::Dispatch(TaskPriority priority, Func&& f)
+{
+    CheckRunning();
+
+    TaskSlot* slot = AllocateSlot();
+    slot->Bind(std::forward<Func>(f));
+    Enqueue(slot, priority);
+}
+
+template<typename Func>
+void ThreadPool::Dispatch(TaskPriority priority, TaskCounter& counter, Func&& f)
+{
+    CheckRunning();
+
+    TaskSlot* slot = AllocateSlot();
+    slot->Bind(std::forward<Func>(f));
+    slot->counter = &counter;
+    counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+    Enqueue(slot, priority);
+}
+
+template<typename Func>
+void ThreadPool::DispatchBatch(TaskPriority priority, size_t count, Func&& f)
+{
+    dispatchBatch(priority, nullptr, count, f);
+}
+
+template<typename Func>
+void ThreadPool::DispatchBatch(TaskPriority priority, TaskCounter& counter, size_t count, Func&& f)
+{
+    dispatchBatch(priority, &counter, count, f);
+}
+
+template<typename Func>
+void ThreadPool::dispatchBatch(TaskPriority priority, TaskCounter* counter, size_t count, Func& f)
+{
+    CheckRunning();
+
+    if(counter)
+        counter->m_pending.fetch_add(static_cast<int64_t>(count), std::memory_order_relaxed);
+
+    constexpr size_t Step = 64;
+    TaskSlot* slots[Step];
+    for(size_t base = 0; base < count; base += Step) {
+        const size_t n = std::min(Step, count - base);
+        for(size_t i = 0; i < n; ++i) {
+            slots[i] = AllocateSlot();
+            slots[i]->Bind([f, index = base + i]() mutable { f(index); });
+            slots[i]->counter = counter;
+        }
+        EnqueueBatch(slots, n, priority);
+    }
 }
 
 } // namespace cp_api
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace cp_api {
+
+    /// Instrumentação do ThreadPool num intervalo (um frame); latência do enqueue ao início, em µs.
+    struct ThreadPoolStats {
+        // bucket 0: < 1 µs; bucket i: [2^(i-1), 2^i) µs; o último acumula o resto (>= ~16 ms)
+        static constexpr size_t LatencyBucketCount = 16;
+
+        struct Worker {
+            double busyMs = 0.0;        // executando tarefas (inclui as aninhadas em Wait)
+            double idleMs = 0.0;        // procurando trabalho, girando ou estacionado
+            uint64_t tasksRun = 0;
+            uint64_t stealsOk = 0;
+            uint64_t stealsFailed = 0;  // Steal() que voltou vazio (corrida perdida ou lane drenada)
+            uint32_t maxQueueDepth = 0; // maior lane própria observada num push
+
+            double Utilisation() const {
+                const double total = busyMs + idleMs;
+                return total > 0.0 ? busyMs / total : 0.0;
+            }
+        };
+
+        std::vector<Worker> workers;   // um por índice de worker
+        uint64_t externalTasksRun = 0; // executadas por threads fora do pool (Wait/WaitUntil)
+        std::array<uint64_t, LatencyBucketCount> latency{};
+        double intervalMs = 0.0;
+
+        uint64_t TotalTasks() const {
+            uint64_t total = externalTasksRun;
+            for (const Worker& w : workers) total += w.tasksRun;
+            return total;
+        }
+
+        double AverageUtilisation() const {
+            if (workers.empty()) return 0.0;
+            double sum = 0.0;
+            for (const Worker& w : workers) sum += w.Utilisation();
+            return sum / static_cast<double>(workers.size());
+        }
+
+        /// Limite superior (µs) do bucket que contém o percentil `p` (0..1); 0 sem amostras.
+        double LatencyPercentileUs(double p) const {
+            uint64_t total = 0;
+            for (uint64_t c : latency) total += c;
+            if (total == 0) return 0.0;
+
+            const double target = p * static_cast<double>(total);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < LatencyBucketCount; ++i) {
+                seen += latency[i];
+                if (static_cast<double>(seen) >= target)
+                    return static_cast<double>(uint64_t(1) << i);
+            }
+            return static_cast<double>(uint64_t(1) << (LatencyBucketCount - 1));
+        }
+    };
+
+} // namespace cp_api
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace cp_api {
+
+    /**
+     * @brief Deque Chase–Lev (Lê et al., PPoPP 2013): o dono mexe embaixo sem trava, ladrões roubam
+     * do topo com um CAS. Buffers antigos só saem no destrutor (um ladrão pode estar lendo).
+     * @tparam T Trivialmente copiável (o pool guarda ponteiros de tarefa).
+     */
+    template<typename T>
+    class WorkStealingDeque {
+        static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque requires trivially copyable elements");
+
+    public:
+        explicit WorkStealingDeque(int64_t initialCapacity = 1024)
+        {
+            int64_t capacity = 1;
+            while (capacity < initialCapacity) capacity <<= 1;
+            m_buffers.push_back(std::make_unique<Buffer>(capacity));
+            m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        // Somente o dono
+        void Push(T item)
+        {
+            int64_t b = m_bottom.load(std::memory_order_relaxed);
+            int64_t t = m_top.load(std::memory_order_acquire);
+            Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+
+            if (b - t > buffer->capacity - 1)
+                buffer = grow(buffer, b, t);
+
+            buffer->Put(b, item);
+            m_bottom.store(b + 1, std::memory_order_release);
+        }
+
+        // Somente o dono (LIFO)
+        bool Pop(T& out)
+        {
+            int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+            Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+            m_bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = m_top.load(std::memory_order_relaxed);
+
+            if (t > b) {
+                // vazio
+                m_bottom.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            out = buffer->Get(b);
+            if (t == b) {
+                // último elemento: disputa com os ladrões
+                bool won = m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                m_bottom.store(b + 1, std::memory_order_relaxed);
+                return won;
+            }
+            return true;
+        }
+
+        // Qualquer thread (FIFO)
+        bool Steal(T& out)
+        {
+            int64_t t = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = m_bottom.load(std::memory_order_acquire);
+
+            if (t >= b)
+                return false;
+
+            Buffer* buffer = m_buffer.load(std::memory_order_acquire);
+            T item = buffer->Get(t);
+            if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return false;
+
+            out = item;
+            return true;
+        }
+
+        // Aproximado quando lido fora do dono
+        int64_t Size() const
+        {
+            int64_t b = m_bottom.load(std::memory_order_relaxed);
+            int64_t t = m_top.load(std::memory_order_relaxed);
+            return b > t ? b - t : 0;
+        }
+
+        bool Empty() const { return Size() == 0; }
+
+    private:
+        struct Buffer {
+            explicit Buffer(int64_t cap)
+                : capacity(cap), mask(cap - 1), items(new std::atomic<T>[static_cast<size_t>(cap)]) {}
+
+            T Get(int64_t i) const { return items[i & mask].load(std::memory_order_relaxed); }
+            void Put(int64_t i, T item) { items[i & mask].store(item, std::memory_order_relaxed); }
+
+            int64_t capacity;
+            int64_t mask;
+            std::unique_ptr<std::atomic<T>[]> items;
+        };
+
+        Buffer* grow(Buffer* old, int64_t bottom, int64_t top)
+        {
+            auto bigger = std::make_unique<Buffer>(old->capacity * 2);
+            for (int64_t i = top; i < bottom; ++i)
+                bigger->Put(i, old->Get(i));
+
+            Buffer* raw = bigger.get();
+            m_buffers.push_back(std::move(bigger));
+            m_buffer.store(raw, std::memory_order_release);
+            return raw;
+        }
+
+    private:
+        alignas(64) std::atomic<int64_t> m_top{ 0 };
+        alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+        alignas(64) std::atomic<Buffer*> m_buffer{ nullptr };
+        std::vector<std::unique_ptr<Buffer>> m_buffers; // só o dono mexe (Push/grow)
+    };
+
+} // namespace cp_api
@@ -8,6 +8,7 @@ namespace cp_api {
     class Window;
     class World;
     class ThreadPool;
+    class FrameScheduler;
     class Framework {
     public:
         Framework();
@@ -15,10 +16,14 @@ namespace cp_api {
 
         void Init();
         void Run();
+
+        /// Corrotinas que fazem co_await NextFrame() retomam no início do próximo frame.
+        FrameScheduler& GetFrameScheduler() { return *m_frameScheduler; }
     private:
         bool m_isInitialized = false;
         bool m_isRunning = false;
         std::unique_ptr<ThreadPool> m_threadPool;
+        std::unique_ptr<FrameScheduler> m_frameScheduler;
         std::unique_ptr<DiagnosticsManager> m_diagnostics;
         std::unique_ptr<World> m_world;
         std::unique_ptr<Window> m_window;
@@ -16,4 +16,10 @@ public:
     void QueryRay(const cp_api::physics3D::Ray& ray, std::vector<cp_api::physics3D::HitInfo>& outInfos, float maxDist, uint32_t queryMask = 0xFFFFFFFF) const;
     void QueryFrustum(const cp_api::shapes3D::Frustum& frustum, std::vector<uint32_t>& outIds, uint32_t queryMask = 0xFFFFFFFF) const;
     void QueryFrustum(const cp_api::shapes3D::Frustum& frustum, std::vector<cp_api::physics3D::HitInfo>& outInfos, uint32_t queryMask = 0xFFFFFFFF) const;
+    /// Mesmo que acima, para vetores no FrameArena (culling por câmera sem malloc).
+    void QueryFrustum(const cp_api::shapes3D::Frustum& frustum, std::pmr::vector<cp_api::physics3D::HitInfo>& outInfos, uint32_t queryMask = 0xFFFFFFFF) const;
+
+private:
+    template<typename OutInfos>
+    void queryFrustumInfos(const cp_api::shapes3D::Frustum& frustum, OutInfos& outInfos, uint32_t queryMask) const;
 };
\ No newline at end of file
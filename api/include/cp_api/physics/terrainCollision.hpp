@@ -3,37 +3,46 @@
 #include "cp_api/containers/spatialTree.hpp"
 #include "cp_api/shapes/triangle.hpp"
 #include "cp_api/shapes/sphere.hpp"
+#include "cp_api/shapes/capsule.hpp"
+#include "cp_api/core/simd.hpp"
+#include "cp_api/physics/terrainKernels.hpp"
 
 #include <algorithm>
 #include <vector>
 #include <cmath>
 #include <limits>
 #include <cstdint>
+#include <span>
+#include <memory_resource>
+
+namespace cp_api {
+    class ThreadPool;
+}
 
 namespace cp_api::physics {
     struct Ray3 {
-        math::Vec3 origin, dir;
-        Ray3(const math::Vec3& o, const math::Vec3& d) : origin(o), dir(d) {}
+        Vec3 origin, dir;
+        Ray3(const Vec3& o, const Vec3& d) : origin(o), dir(d) {}
     };
 
     struct RayHit3 {
-        math::Vec3 position;
-        math::Vec3 normal;
+        Vec3 position;
+        Vec3 normal;
         float distance = std::numeric_limits<float>::max();
         uint32_t triangleId = UINT32_MAX;
         bool hit = false;
     };
 
-    static float pointToTriangleDistanceSq(const math::Vec3& p, const shapes::Triangle& tri, math::Vec3& closest) {
-        math::Vec3 ab = tri.v1 - tri.v0;
-        math::Vec3 ac = tri.v2 - tri.v0;
-        math::Vec3 ap = p - tri.v0;
+    static float pointToTriangleDistanceSq(const Vec3& p, const shapes::Triangle& tri, Vec3& closest) {
+        Vec3 ab = tri.v1 - tri.v0;
+        Vec3 ac = tri.v2 - tri.v0;
+        Vec3 ap = p - tri.v0;
 
         float d1 = dot(ab, ap);
         float d2 = dot(ac, ap);
         if (d1 <= 0.0f && d2 <= 0.0f) { closest = tri.v0; return dot(p - tri.v0, p - tri.v0); }
 
-        math::Vec3 bp = p - tri.v1;
+        Vec3 bp = p - tri.v1;
         float d3 = dot(ab, bp);
         float d4 = dot(ac, bp);
         if (d3 >= 0.0f && d4 <= d3) { closest = tri.v1; return dot(p - tri.v1, p - tri.v1); }
@@ -46,7 +55,7 @@ namespace cp_api::physics {
             return dot(p - closest, p - closest);
         }
 
-        math::Vec3 cp = p - tri.v2;
+        Vec3 cp = p - tri.v2;
         float d5 = dot(ab, cp);
         float d6 = dot(ac, cp);
         if (d6 >= 0.0f && d5 <= d6) { closest = tri.v2; return dot(p - tri.v2, p - tri.v2); }
@@ -74,13 +83,13 @@ namespace cp_api::physics {
         return dot(p - closest, p - closest);
     }
 
-    static bool sphereIntersectsTriangle(const shapes::Sphere& s, const shapes::Triangle& tri, math::Vec3& outNormal, float& outPenetration) {
-        math::Vec3 closest;
+    static bool sphereIntersectsTriangle(const shapes3D::Sphere& s, const shapes::Triangle& tri, Vec3& outNormal, float& outPenetration) {
+        Vec3 closest;
         float distSq = pointToTriangleDistanceSq(s.center, tri, closest);
         if (distSq > s.radius * s.radius)
             return false;
 
-        math::Vec3 dir = s.center - closest;
+        Vec3 dir = s.center - closest;
         float dist = std::sqrt(distSq);
         if (dist > 1e-6f)
             outNormal = math::Normalize(dir);
@@ -92,20 +101,20 @@ namespace cp_api::physics {
 
     // Ray-triangle (Möller–Trumbore)
     static bool rayIntersectsTriangle(
-        const math::Vec3& orig, const math::Vec3& dir,
-        const shapes::Triangle& tri, float& outT, math::Vec3& outNormal)
+        const Vec3& orig, const Vec3& dir,
+        const shapes::Triangle& tri, float& outT, Vec3& outNormal)
     {
         const float EPS = 1e-6f;
-        math::Vec3 edge1 = tri.v1 - tri.v0;
-        math::Vec3 edge2 = tri.v2 - tri.v0;
-        math::Vec3 pvec = math::Cross(dir, edge2);
+        Vec3 edge1 = tri.v1 - tri.v0;
+        Vec3 edge2 = tri.v2 - tri.v0;
+        Vec3 pvec = math::Cross(dir, edge2);
         float det = math::Dot(edge1, pvec);
         if (fabs(det) < EPS) return false;
         float invDet = 1.0f / det;
-        math::Vec3 tvec = orig - tri.v0;
+        Vec3 tvec = orig - tri.v0;
         float u = math::Dot(tvec, pvec) * invDet;
         if (u < 0.0f || u > 1.0f) return false;
-        math::Vec3 qvec = math::Cross(tvec, edge1);
+        Vec3 qvec = math::Cross(tvec, edge1);
         float v = math::Dot(dir, qvec) * invDet;
         if (v < 0.0f || u + v > 1.0f) return false;
         float t = math::Dot(edge2, qvec) * invDet;
@@ -115,16 +124,311 @@ namespace cp_api::physics {
         return true;
     }
 
+    // Pontos mais próximos entre os segmentos p1-q1 e p2-q2 (Ericson 5.1.9)
+    static float closestPtSegmentSegment(const Vec3& p1, const Vec3& q1, const Vec3& p2, const Vec3& q2,
+                                         Vec3& c1, Vec3& c2)
+    {
+        const float EPS = 1e-8f;
+        Vec3 d1 = q1 - p1;
+        Vec3 d2 = q2 - p2;
+        Vec3 r = p1 - p2;
+        float a = math::Dot(d1, d1);
+        float e = math::Dot(d2, d2);
+        float f = math::Dot(d2, r);
+        float s, t;
+
+        if (a <= EPS && e <= EPS) {
+            c1 = p1; c2 = p2;
+            return math::Dot(c1 - c2, c1 - c2);
+        }
+        if (a <= EPS) {
+            s = 0.0f;
+            t = std::clamp(f / e, 0.0f, 1.0f);
+        } else {
+            float c = math::Dot(d1, r);
+            if (e <= EPS) {
+                t = 0.0f;
+                s = std::clamp(-c / a, 0.0f, 1.0f);
+            } else {
+                float b = math::Dot(d1, d2);
+                float denom = a * e - b * b;
+                s = (denom != 0.0f) ? std::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+                t = (b * s + f) / e;
+                if (t < 0.0f) { t = 0.0f; s = std::clamp(-c / a, 0.0f, 1.0f); }
+                else if (t > 1.0f) { t = 1.0f; s = std::clamp((b - c) / a, 0.0f, 1.0f); }
+            }
+        }
+
+        c1 = p1 + d1 * s;
+        c2 = p2 + d2 * t;
+        return math::Dot(c1 - c2, c1 - c2);
+    }
+
+    // Distância exata segmento ↔ triângulo: interseção, extremidades contra a face e arestas contra o segmento
+    static float segmentToTriangleDistanceSq(const Vec3& p, const Vec3& q, const shapes::Triangle& tri,
+                                             Vec3& onSegment, Vec3& onTriangle)
+    {
+        // o segmento atravessa a face?
+        Vec3 dir = q - p;
+        Vec3 edge1 = tri.v1 - tri.v0;
+        Vec3 edge2 = tri.v2 - tri.v0;
+        Vec3 pvec = math::Cross(dir, edge2);
+        float det = math::Dot(edge1, pvec);
+        if (fabs(det) > 1e-8f) {
+            float invDet = 1.0f / det;
+            Vec3 tvec = p - tri.v0;
+            float u = math::Dot(tvec, pvec) * invDet;
+            Vec3 qvec = math::Cross(tvec, edge1);
+            float v = math::Dot(dir, qvec) * invDet;
+            float t = math::Dot(edge2, qvec) * invDet;
+            if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f && t <= 1.0f) {
+                onSegment = onTriangle = p + dir * t;
+                return 0.0f;
+            }
+        }
+
+        float best = pointToTriangleDistanceSq(p, tri, onTriangle);
+        onSegment = p;
+
+        Vec3 closest;
+        float d = pointToTriangleDistanceSq(q, tri, closest);
+        if (d < best) { best = d; onSegment = q; onTriangle = closest; }
+
+        const Vec3* verts[3] = { &tri.v0, &tri.v1, &tri.v2 };
+        for (int i = 0; i < 3; ++i) {
+            Vec3 cs, ct;
+            d = closestPtSegmentSegment(p, q, *verts[i], *verts[(i + 1) % 3], cs, ct);
+            if (d < best) { best = d; onSegment = cs; onTriangle = ct; }
+        }
+        return best;
+    }
+
+    // Menor raiz de a*t² + b*t + c = 0 em [0, tMax]
+    static bool lowestRootInRange(float a, float b, float c, float tMax, float& outT)
+    {
+        if (fabs(a) < 1e-12f) {
+            if (fabs(b) < 1e-12f) return false;
+            float t = -c / b;
+            if (t < 0.0f || t > tMax) return false;
+            outT = t;
+            return true;
+        }
+
+        float disc = b * b - 4.0f * a * c;
+        if (disc < 0.0f) return false;
+
+        float sq = std::sqrt(disc);
+        float r1 = (-b - sq) / (2.0f * a);
+        float r2 = (-b + sq) / (2.0f * a);
+        if (r1 > r2) std::swap(r1, r2);
+
+        if (r1 >= 0.0f && r1 <= tMax) { outT = r1; return true; }
+        if (r2 >= 0.0f && r2 <= tMax) { outT = r2; return true; }
+        return false;
+    }
+
+    /**
+     * @brief Exact swept sphere vs triangle: center moves from start to start + delta.
+     *
+     * Tests the face first (earliest contact when the touch point lies inside the triangle),
+     * then the three vertices and the three edges. Starting in contact returns t = 0.
+     * @param tMax Only hits with t <= tMax are reported (current best, in [0,1]).
+     * @param outT Fraction of delta at first contact.
+     * @param outContact Contact point on the triangle.
+     */
+    static bool sweptSphereIntersectsTriangle(const Vec3& start, const Vec3& delta, float radius,
+                                              const shapes::Triangle& tri, float tMax,
+                                              float& outT, Vec3& outContact)
+    {
+        const float r2 = radius * radius;
+
+        Vec3 closest;
+        if (pointToTriangleDistanceSq(start, tri, closest) <= r2) {
+            outT = 0.0f;
+            outContact = closest;
+            return true;
+        }
+
+        Vec3 n = math::Cross(tri.v1 - tri.v0, tri.v2 - tri.v0);
+        float nLen = math::Length(n);
+        if (nLen < 1e-12f) return false; // triângulo degenerado
+        n = n / nLen;
+        const Vec3 faceNormal = n; // winding original, para o teste de ponto dentro
+
+        // orienta a normal para o lado em que a esfera começa
+        float s0 = math::Dot(n, start - tri.v0);
+        if (s0 < 0.0f) { n = -n; s0 = -s0; }
+        float nd = math::Dot(n, delta);
+
+        bool found = false;
+        float best = tMax;
+
+        // 1) face: toca o plano em s(t) = radius
+        if (nd < -1e-12f) {
+            float t = (s0 - radius) / -nd;
+            if (t > best) return false; // vértices e arestas só podem tocar depois do plano
+            if (t >= 0.0f) {
+                Vec3 onPlane = start + delta * t - n * radius;
+                // ponto dentro do triângulo (coordenadas baricêntricas por arestas)
+                Vec3 c0 = math::Cross(tri.v1 - tri.v0, onPlane - tri.v0);
+                Vec3 c1 = math::Cross(tri.v2 - tri.v1, onPlane - tri.v1);
+                Vec3 c2 = math::Cross(tri.v0 - tri.v2, onPlane - tri.v2);
+                if (math::Dot(c0, faceNormal) >= 0.0f && math::Dot(c1, faceNormal) >= 0.0f && math::Dot(c2, faceNormal) >= 0.0f) {
+                    outT = t;
+                    outContact = onPlane;
+                    return true;
+                }
+            }
+        } else if (s0 > radius) {
+            return false; // paralelo ou se afastando, fora do alcance do plano
+        }
+
+        // 2) vértices: |start + t*delta - V|² = r²
+        const float a = math::Dot(delta, delta);
+        if (a < 1e-12f) return false;
+
+        const Vec3* verts[3] = { &tri.v0, &tri.v1, &tri.v2 };
+        for (const Vec3* v : verts) {
+            Vec3 m = start - *v;
+            float t;
+            if (lowestRootInRange(a, 2.0f * math::Dot(delta, m), math::Dot(m, m) - r2, best, t)) {
+                best = t;
+                outContact = *v;
+                found = true;
+            }
+        }
+
+        // 3) arestas: distância do centro à reta da aresta = r, com o pé dentro da aresta
+        for (int i = 0; i < 3; ++i) {
+            const Vec3& p0 = *verts[i];
+            const Vec3 edge = *verts[(i + 1) % 3] - p0;
+            const Vec3 baseToVertex = p0 - start;
+            const float edgeSq = math::Dot(edge, edge);
+            const float edgeDotDelta = math::Dot(edge, delta);
+            const float edgeDotBase = math::Dot(edge, baseToVertex);
+
+            const float ea = edgeSq * -a + edgeDotDelta * edgeDotDelta;
+            const float eb = edgeSq * (2.0f * math::Dot(delta, baseToVertex)) - 2.0f * edgeDotDelta * edgeDotBase;
+            const float ec = edgeSq * (r2 - math::Dot(baseToVertex, baseToVertex)) + edgeDotBase * edgeDotBase;
+
+            float t;
+            if (lowestRootInRange(ea, eb, ec, best, t)) {
+                float f = (edgeDotDelta * t - edgeDotBase) / edgeSq;
+                if (f >= 0.0f && f <= 1.0f) {
+                    best = t;
+                    outContact = p0 + edge * f;
+                    found = true;
+                }
+            }
+        }
+
+        if (found) outT = best;
+        return found;
+    }
+
+    /**
+     * @brief Exact swept capsule vs triangle: the segment p0-p1 moves by delta.
+     *
+     * The first contact is an endpoint of the segment against the triangle (swept spheres),
+     * the segment interior against an edge interior (the distance between both lines reaches
+     * radius) or the segment interior against a vertex (the vertex swept by -delta against the
+     * cylinder around the segment). The segment interior only reaches the face together with
+     * an endpoint. Starting in contact returns t = 0.
+     * @param tMax Only hits with t <= tMax are reported (current best, in [0,1]).
+     * @param outT Fraction of delta at first contact.
+     */
+    static bool sweptCapsuleIntersectsTriangle(const Vec3& p0, const Vec3& p1, const Vec3& delta, float radius,
+                                               const shapes::Triangle& tri, float tMax, float& outT)
+    {
+        const float r2 = radius * radius;
+
+        Vec3 onSeg, onTri;
+        if (segmentToTriangleDistanceSq(p0, p1, tri, onSeg, onTri) <= r2) {
+            outT = 0.0f;
+            return true;
+        }
+
+        bool found = false;
+        float best = tMax;
+        float t;
+        Vec3 contact;
+
+        // 1) extremidades: esferas varridas
+        if (sweptSphereIntersectsTriangle(p0, delta, radius, tri, best, t, contact)) { best = t; found = true; }
+        if (sweptSphereIntersectsTriangle(p1, delta, radius, tri, best, t, contact)) { best = t; found = true; }
+
+        const Vec3 seg = p1 - p0;
+        const float segSq = math::Dot(seg, seg);
+        const float a = math::Dot(delta, delta);
+        if (segSq < 1e-12f || a < 1e-12f) {
+            if (found) outT = best;
+            return found; // cápsula degenerada em esfera, ou parada
+        }
+
+        const Vec3* verts[3] = { &tri.v0, &tri.v1, &tri.v2 };
+        for (int i = 0; i < 3; ++i) {
+            const Vec3& v = *verts[i];
+            const Vec3 edge = *verts[(i + 1) % 3] - v;
+            const float edgeSq = math::Dot(edge, edge);
+
+            // 2) interior do segmento contra interior da aresta: distância entre as retas = r
+            Vec3 n = math::Cross(seg, edge);
+            const float nLen = math::Length(n);
+            if (nLen > 1e-6f * std::sqrt(segSq * edgeSq)) { // paralelos: tocam antes pelas pontas
+                n = n / nLen;
+                const float c = math::Dot(p0 - v, n);
+                const float k = math::Dot(delta, n);
+                if (fabs(c) > radius && c * k < 0.0f) {
+                    t = (c - std::copysign(radius, c)) / -k;
+                    if (t <= best) {
+                        // pontos mais próximos das retas nesse instante precisam cair nos dois segmentos
+                        const Vec3 w = p0 + delta * t - v;
+                        const float b = math::Dot(seg, edge);
+                        const float d = math::Dot(seg, w);
+                        const float f = math::Dot(edge, w);
+                        const float denom = segSq * edgeSq - b * b;
+                        const float sSeg = (b * f - d * edgeSq) / denom;
+                        const float sEdge = (segSq * f - b * d) / denom;
+                        if (sSeg >= 0.0f && sSeg <= 1.0f && sEdge >= 0.0f && sEdge <= 1.0f) {
+                            best = t;
+                            found = true;
+                        }
+                    }
+                }
+            }
+
+            // 3) vértice contra o interior do segmento: o vértice anda -delta até o cilindro
+            const Vec3 baseToVertex = p0 - v;
+            const float segDotDelta = -math::Dot(seg, delta);
+            const float segDotBase = math::Dot(seg, baseToVertex);
+
+            const float ea = segSq * -a + segDotDelta * segDotDelta;
+            const float eb = segSq * (2.0f * -math::Dot(delta, baseToVertex)) - 2.0f * segDotDelta * segDotBase;
+            const float ec = segSq * (r2 - math::Dot(baseToVertex, baseToVertex)) + segDotBase * segDotBase;
+
+            if (lowestRootInRange(ea, eb, ec, best, t)) {
+                const float f = (segDotDelta * t - segDotBase) / segSq;
+                if (f >= 0.0f && f <= 1.0f) {
+                    best = t;
+                    found = true;
+                }
+            }
+        }
+
+        if (found) outT = best;
+        return found;
+    }
+
     struct AABB3 {
-        math::Vec3 min, max;
+        Vec3 min, max;
         AABB3() {}
-        AABB3(const math::Vec3& mi, const math::Vec3& ma) : min(mi), max(ma) {}
-        math::Vec3 Center() const { return math::Vec3((min.x+max.x)*0.5f, (min.y+max.y)*0.5f, (min.z+max.z)*0.5f); }
+        AABB3(const Vec3& mi, const Vec3& ma) : min(mi), max(ma) {}
+        Vec3 Center() const { return Vec3((min.x+max.x)*0.5f, (min.y+max.y)*0.5f, (min.z+max.z)*0.5f); }
 
-        math::Vec3 Min() const { return min; }
-        math::Vec3 Max() const { return max; }
+        Vec3 Min() const { return min; }
+        Vec3 Max() const { return max; }
 
-        bool Contains(const math::Vec3& p) const {
+        bool Contains(const Vec3& p) const {
             return p.x>=min.x && p.x<=max.x &&
                 p.y>=min.y && p.y<=max.y &&
                 p.z>=min.z && p.z<=max.z;
@@ -190,93 +494,169 @@ namespace cp_api::physics {
         }
     };
 
+    // Resultado de uma varredura (colisão contínua)
+    struct SweepHit3 {
+        Vec3 position;      // posição do centro (esfera) ou deslocamento aplicado (cápsula) no impacto
+        Vec3 contact;       // ponto de contato no triângulo
+        Vec3 normal;        // normal de contato, apontando para fora do terreno
+        float toi = 1.0f;   // fração do movimento até o impacto [0,1]
+        uint32_t triangleId = UINT32_MAX;
+        bool hit = false;
+    };
+
+    // ------------------------------------------------------------
+    // Kernels SoA (TriangleBlock8 e variantes por ISA em terrainKernels.hpp)
+    // ------------------------------------------------------------
+    /**
+     * @brief Möller–Trumbore against every triangle of a block.
+     * @param bestT In: current closest distance. Out: updated when a closer hit is found.
+     * @param outLane Lane of the closest hit (only written on hit).
+     * @return true if some lane hit closer than the incoming bestT.
+     */
+    bool RayIntersectsTriangleBlock(const Vec3& orig, const Vec3& dir, const TriangleBlock8& block, float& bestT, int& outLane);
+
+    /**
+     * @brief Sphere against every triangle of a block.
+     * @param correction Accumulates normal * penetration of each touching triangle.
+     * @return Number of triangles touching the sphere.
+     */
+    int SphereIntersectsTriangleBlock(const shapes3D::Sphere& s, const TriangleBlock8& block, Vec3& correction);
+
     // ------------------------------------------------------------
     // Classe principal: TerrainCollider
     // ------------------------------------------------------------
     class TerrainCollider {
     public:
-        using Tree = SpatialTree<math::Vec3, AABB3, Ray3, RayHit3, 8>;
+        using Tree = SpatialTree<Vec3, AABB3, Ray3, RayHit3, 8>;
 
         TerrainCollider(const AABB3& worldBounds)
-            : m_tree(worldBounds, 8, 8) {}
+            : m_tree(worldBounds, 8, 8), m_bounds(worldBounds) {}
+
+        // Adiciona um triângulo de terreno (fica pendente até o próximo Build)
+        void AddTriangle(const Vec3& v0, const Vec3& v1, const Vec3& v2);
+
+        /**
+         * @brief Add an indexed mesh in one linear pass over the index list.
+         *
+         * Vertices are read in place, not kept: the SoA blocks are the only copy of the geometry.
+         * Per triangle that is one block lane (sizeof(TriangleBlock8) / 8 = 44 B, more when the
+         * leaf's last block is partly empty), a 4 B id -> lane slot and one tree Entry (~40 B);
+         * until Build the triangle waits as v0/edge1/edge2 (36 B). GetMemoryUsage() reports it.
+         *
+         * Trade-off: shared vertices + 32-bit indices would cost ~12 B per triangle plus the
+         * vertices, but the SoA narrowphase needs each lane's v0/edges contiguous, and gathering
+         * them through indices on every query costs more than it saves. So this is about the old
+         * 48 B per Triangle, not half of it; the win is the single pass and no per-triangle copy.
+         *
+         * When the collider is empty the tree is bulk-built; otherwise the triangles are inserted
+         * incrementally.
+         * @param vertices Mesh vertex positions.
+         * @param indices Triangle list, 3 indices per triangle (size must be a multiple of 3).
+         */
+        void AddMesh(std::span<const Vec3> vertices, std::span<const uint32_t> indices);
 
-        // Adiciona um triângulo de terreno
-        void AddTriangle(const math::Vec3& v0, const math::Vec3& v1, const math::Vec3& v2) {
-            shapes::Triangle tri{ v0, v1, v2, math::Normalize(math::Cross(v1 - v0, v2 - v0)) };
-            uint32_t id = static_cast<uint32_t>(m_triangles.size());
-            m_triangles.push_back(tri);
+        // Colisão esfera ↔ terreno (retorna true se houve colisão)
+        bool CollideSphere(shapes3D::Sphere& s, Vec3& correctionOut);
+
+        // Colisão cápsula ↔ terreno (retorna true se houve colisão)
+        bool CollideCapsule(shapes3D::Capsule& c, Vec3& correctionOut);
+
+        /**
+         * @brief Resolve many spheres against the terrain in parallel.
+         *
+         * Queries are sorted in Morton order (cache locality in the tree and blocks) and split
+         * into one contiguous chunk per worker, each with its own scratch buffers; the calling
+         * thread processes the first chunk. Inputs are not modified. The Morton order and the
+         * chunk scratch come from the FrameArena of the threads involved, so batches and single
+         * queries on the same built collider may overlap.
+         * @param pool Pool used for the work.
+         * @param spheres Spheres to resolve.
+         * @param correctionsOut Per-sphere correction (zero when not colliding); same size as spheres.
+         * @return Number of spheres that collided.
+         */
+        size_t CollideSpheres(ThreadPool& pool, std::span<const shapes3D::Sphere> spheres, std::span<Vec3> correctionsOut);
+
+        /// Igual a CollideSpheres, para cápsulas.
+        size_t CollideCapsules(ThreadPool& pool, std::span<const shapes3D::Capsule> capsules, std::span<Vec3> correctionsOut);
+
+        /**
+         * @brief Continuous collision of a sphere moving from start to end.
+         * Only triangles in tree nodes overlapping the swept volume are tested, each with an
+         * exact swept-sphere test.
+         * @return true on impact; outHit holds the time of impact, normal and triangle id.
+         */
+        bool SweepSphere(const Vec3& start, const Vec3& end, float radius, SweepHit3& outHit);
+
+        /**
+         * @brief Continuous collision of a capsule translated by delta.
+         * Exact per-triangle test (sweptCapsuleIntersectsTriangle), so it never skips a contact
+         * and never gives up on grazing motions.
+         */
+        bool SweepCapsule(const shapes3D::Capsule& capsule, const Vec3& delta, SweepHit3& outHit);
+
+        static constexpr float SweepTolerance = 1e-4f;
 
-            math::Vec3 bmin = glm::min(glm::min(v0, v1), v2);
-            math::Vec3 bmax = glm::max(glm::max(v0, v1), v2);
-            AABB3 aabb{ bmin, bmax };
+        // Raycast contra terreno (retorna o hit mais próximo)
+        bool Raycast(const Vec3& origin, const Vec3& dir, float maxDist, RayHit3& outHit);
 
-            m_tree.Insert(id, aabb);
-        }
+        /**
+         * @brief Rebuild the per-node SoA triangle blocks and drop the pending triangles.
+         * Required after adding triangles: queries throw on an unbuilt collider instead of
+         * rebuilding, so once built they only read and may run from several threads at once.
+         * Briefly holds the old and new blocks.
+         */
+        void Build();
 
-        // Colisão esfera ↔ terreno (retorna true se houve colisão)
-        bool CollideSphere(shapes::Sphere& s, math::Vec3& correctionOut)
-        {
-            AABB3 queryBox{
-                s.center - math::Vec3(s.radius),
-                s.center + math::Vec3(s.radius)
-            };
-
-            std::vector<uint32_t> candidates;
-            m_tree.QueryRange(queryBox, candidates);
-
-            bool collided = false;
-            correctionOut = math::Vec3(0.0f);
-
-            for (uint32_t id : candidates)
-            {
-                const shapes::Triangle& tri = m_triangles[id];
-                math::Vec3 normal;
-                float penetration;
-
-                if (sphereIntersectsTriangle(s, tri, normal, penetration))
-                {
-                    correctionOut += normal * penetration;
-                    collided = true;
-                }
-            }
+        /// Vértices reconstruídos como v0 + aresta (podem diferir no último bit dos originais).
+        shapes::Triangle GetTriangle(uint32_t id) const;
 
-            if (collided)
-                s.center += correctionOut;
+        /// Normal da face, calculada a partir das arestas (não é armazenada).
+        Vec3 GetTriangleNormal(uint32_t id) const;
 
-            return collided;
-        }
+        size_t GetTriangleCount() const { return m_triangleSlots.size() + m_pending.size() / 3; }
+        const AABB3& GetBounds() const { return m_bounds; }
 
-        // Raycast contra terreno (retorna o hit mais próximo)
-        bool Raycast(const math::Vec3& origin, const math::Vec3& dir, float maxDist, RayHit3& outHit) {
-            math::Vec3 end = origin + dir * maxDist;
-            math::Vec3 qmin = glm::min(origin, end);
-            math::Vec3 qmax = glm::max(origin, end);
-            AABB3 queryBox{ qmin, qmax };
-
-            std::vector<uint32_t> candidates;
-            m_tree.QueryRange(queryBox, candidates);
-
-            bool hit = false;
-            float bestT = maxDist;
-
-            for (uint32_t id : candidates) {
-                float t;
-                math::Vec3 n;
-                if (rayIntersectsTriangle(origin, dir, m_triangles[id], t, n) && t < bestT) {
-                    bestT = t;
-                    outHit.hit = true;
-                    outHit.distance = t;
-                    outHit.triangleId = id;
-                    outHit.normal = n;
-                    outHit.position = origin + dir * t;
-                    hit = true;
-                }
-            }
-            return hit;
-        }
+        /// Memória aproximada ocupada pelo collider (blocos SoA, pendentes e árvore), em bytes.
+        size_t GetMemoryUsage() const;
+
+    private:
+        struct BlockRange {
+            uint32_t first = 0;
+            uint32_t count = 0;
+        };
+
+        // buffers temporários de uma consulta, no FrameArena de quem consulta
+        struct QueryScratch {
+            explicit QueryScratch(std::pmr::memory_resource* resource)
+                : nodes(resource) {}
+
+            std::pmr::vector<const Tree::Node*> nodes;
+        };
+
+        void requireBuilt() const;
+        bool collideSphere(const shapes3D::Sphere& s, Vec3& correctionOut, QueryScratch& scratch) const;
+        bool collideCapsule(const shapes3D::Capsule& c, Vec3& correctionOut, QueryScratch& scratch) const;
+
+        template<typename Shape, typename CenterFn, typename CollideFn>
+        size_t collideBatch(ThreadPool& pool, std::span<const Shape> shapes, std::span<Vec3> correctionsOut,
+                            CenterFn&& center, CollideFn&& collide);
+
+        uint32_t mortonCode(const Vec3& p) const;
+
+        template<typename Fn>
+        void forEachTriangleInBox(const AABB3& box, QueryScratch& scratch, Fn&& fn) const;
+
+        // v0 e arestas do triângulo, dos blocos ou dos pendentes
+        void triangleEdges(uint32_t id, Vec3& v0, Vec3& e1, Vec3& e2) const;
 
     private:
         Tree m_tree;
-        std::vector<shapes::Triangle> m_triangles;
+        AABB3 m_bounds;
+        // narrowphase SoA: blocos contíguos por nó da árvore; única cópia dos triângulos construídos
+        std::vector<TriangleBlock8> m_blocks;
+        std::vector<BlockRange> m_nodeBlocks;    // por nó com itens, indexado por Node::userIndex
+        std::vector<uint32_t> m_triangleSlots;   // id -> bloco * Width + lane
+        std::vector<Vec3> m_pending;             // v0, e1, e2 dos ids >= m_triangleSlots.size(), até o Build
+        bool m_blocksDirty = false;
     };
-}
\ No newline at end of file
+}
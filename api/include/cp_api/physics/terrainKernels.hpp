@@ -0,0 +1,49 @@
+#pragma once
+
+// Sem glm nem std além do básico: este header entra nos TUs compilados com AVX2.
+#include "cp_api/core/simd.hpp"
+
+#include <cstdint>
+
+namespace cp_api::physics {
+
+    // ------------------------------------------------------------
+    // Bloco SoA de triângulos (narrowphase SIMD)
+    // ------------------------------------------------------------
+    /**
+     * @brief Up to 8 triangles of one tree node stored as SoA (v0, edge1, edge2).
+     *
+     * Lanes past `count` are zero-filled and masked out by the kernels.
+     */
+    struct TriangleBlock8 {
+        alignas(32) float v0x[simd::Width], v0y[simd::Width], v0z[simd::Width];
+        alignas(32) float e1x[simd::Width], e1y[simd::Width], e1z[simd::Width];
+        alignas(32) float e2x[simd::Width], e2y[simd::Width], e2z[simd::Width];
+        uint32_t ids[simd::Width];
+        uint32_t count = 0;
+    };
+
+    /// Distância e direção (centro - ponto mais próximo, normalizada) por lane.
+    struct SphereBlockContacts {
+        alignas(32) float dist[simd::Width];
+        alignas(32) float nx[simd::Width], ny[simd::Width], nz[simd::Width];
+    };
+
+    /**
+     * @brief Kernels of one ISA variant; GetTriangleKernels() picks the best one for this CPU.
+     */
+    struct TriangleKernels {
+        /// Möller–Trumbore; bestT/outLane como em RayIntersectsTriangleBlock.
+        bool (*rayBlock)(const float (&orig)[3], const float (&dir)[3], const TriangleBlock8& block,
+                         float& bestT, int& outLane);
+        /// Máscara das lanes a até `radius` do centro.
+        int (*sphereBlock)(const float (&center)[3], float radius, const TriangleBlock8& block,
+                           SphereBlockContacts& out);
+    };
+
+    extern const TriangleKernels TriangleKernelsBaseline; // ISA padrão do build (SSE2 no x64)
+    extern const TriangleKernels TriangleKernelsAVX2;     // só existe com CP_SIMD_HAS_AVX2_KERNELS
+
+    const TriangleKernels& GetTriangleKernels();
+
+} // namespace cp_api::physics
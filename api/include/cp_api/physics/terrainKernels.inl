@@ -0,0 +1,136 @@
+// Corpo dos kernels de triângulos, incluído uma vez por ISA (terrainKernels.cpp,
+// terrainKernelsAVX2.cpp). Quem inclui define CP_TERRAIN_KERNELS_TABLE.
+#include "cp_api/physics/terrainKernels.hpp"
+
+namespace cp_api::physics {
+    namespace {
+        using namespace simd;
+
+        bool RayBlock(const float (&orig)[3], const float (&dir)[3], const TriangleBlock8& block, float& bestT, int& outLane)
+        {
+            const Float8 EPS = Set1(1e-6f);
+            const Float8 ZERO = Zero();
+            const Float8 ONE = Set1(1.0f);
+
+            const Float8 dx = Set1(dir[0]), dy = Set1(dir[1]), dz = Set1(dir[2]);
+            const Float8 e1x = Load(block.e1x), e1y = Load(block.e1y), e1z = Load(block.e1z);
+            const Float8 e2x = Load(block.e2x), e2y = Load(block.e2y), e2z = Load(block.e2z);
+
+            Float8 px, py, pz;
+            Cross3(dx, dy, dz, e2x, e2y, e2z, px, py, pz);
+            const Float8 det = Dot3(e1x, e1y, e1z, px, py, pz);
+            const Float8 invDet = ONE / det;
+
+            const Float8 tx = Set1(orig[0]) - Load(block.v0x);
+            const Float8 ty = Set1(orig[1]) - Load(block.v0y);
+            const Float8 tz = Set1(orig[2]) - Load(block.v0z);
+            const Float8 u = Dot3(tx, ty, tz, px, py, pz) * invDet;
+
+            Float8 qx, qy, qz;
+            Cross3(tx, ty, tz, e1x, e1y, e1z, qx, qy, qz);
+            const Float8 v = Dot3(dx, dy, dz, qx, qy, qz) * invDet;
+            const Float8 t = Dot3(e2x, e2y, e2z, qx, qy, qz) * invDet;
+
+            // det ~ 0 gera inf/nan em u/v/t; as comparações ordenadas descartam essas lanes
+            const Mask8 hit = (Abs(det) >= EPS) &
+                              (u >= ZERO) & (u <= ONE) &
+                              (v >= ZERO) & ((u + v) <= ONE) &
+                              (t > EPS) & (t < Set1(bestT));
+
+            int bits = MoveMask(hit) & LaneMask(block.count);
+            if (!bits) return false;
+
+            alignas(32) float ts[Width];
+            Store(ts, t);
+            for (int lane = 0; lane < Width; ++lane) {
+                if ((bits & (1 << lane)) && ts[lane] < bestT) {
+                    bestT = ts[lane];
+                    outLane = lane;
+                }
+            }
+            return true;
+        }
+
+        int SphereBlock(const float (&center)[3], float radius, const TriangleBlock8& block, SphereBlockContacts& out)
+        {
+            const Float8 ZERO = Zero();
+            const Float8 ONE = Set1(1.0f);
+
+            const Float8 e1x = Load(block.e1x), e1y = Load(block.e1y), e1z = Load(block.e1z);
+            const Float8 e2x = Load(block.e2x), e2y = Load(block.e2y), e2z = Load(block.e2z);
+            const Float8 apx = Set1(center[0]) - Load(block.v0x);
+            const Float8 apy = Set1(center[1]) - Load(block.v0y);
+            const Float8 apz = Set1(center[2]) - Load(block.v0z);
+
+            // Mesmas regiões de Voronoi de pointToTriangleDistanceSq (Ericson), sem desvios:
+            // o ponto mais próximo é v0 + sb * edge1 + sc * edge2.
+            const Float8 abab = Dot3(e1x, e1y, e1z, e1x, e1y, e1z);
+            const Float8 abac = Dot3(e1x, e1y, e1z, e2x, e2y, e2z);
+            const Float8 acac = Dot3(e2x, e2y, e2z, e2x, e2y, e2z);
+
+            const Float8 d1 = Dot3(e1x, e1y, e1z, apx, apy, apz);
+            const Float8 d2 = Dot3(e2x, e2y, e2z, apx, apy, apz);
+            const Float8 d3 = d1 - abab;
+            const Float8 d4 = d2 - abac;
+            const Float8 d5 = d1 - abac;
+            const Float8 d6 = d2 - acac;
+
+            const Float8 vc = d1 * d4 - d3 * d2;
+            const Float8 vb = d5 * d2 - d1 * d6;
+            const Float8 va = d3 * d6 - d5 * d4;
+
+            // interior
+            const Float8 denom = ONE / (va + vb + vc);
+            Float8 sb = vb * denom;
+            Float8 sc = vc * denom;
+
+            // aplicadas da menor para a maior prioridade: a última seleção vence
+            const Float8 d43 = d4 - d3;
+            const Float8 d56 = d5 - d6;
+            const Mask8 edgeBC = (va <= ZERO) & (d43 >= ZERO) & (d56 >= ZERO);
+            const Float8 wbc = d43 / (d43 + d56);
+            sb = Select(edgeBC, ONE - wbc, sb);
+            sc = Select(edgeBC, wbc, sc);
+
+            const Mask8 edgeAC = (vb <= ZERO) & (d2 >= ZERO) & (d6 <= ZERO);
+            sb = Select(edgeAC, ZERO, sb);
+            sc = Select(edgeAC, d2 / (d2 - d6), sc);
+
+            const Mask8 vertC = (d6 >= ZERO) & (d5 <= d6);
+            sb = Select(vertC, ZERO, sb);
+            sc = Select(vertC, ONE, sc);
+
+            const Mask8 edgeAB = (vc <= ZERO) & (d1 >= ZERO) & (d3 <= ZERO);
+            sb = Select(edgeAB, d1 / (d1 - d3), sb);
+            sc = Select(edgeAB, ZERO, sc);
+
+            const Mask8 vertB = (d3 >= ZERO) & (d4 <= d3);
+            sb = Select(vertB, ONE, sb);
+            sc = Select(vertB, ZERO, sc);
+
+            const Mask8 vertA = (d1 <= ZERO) & (d2 <= ZERO);
+            sb = Select(vertA, ZERO, sb);
+            sc = Select(vertA, ZERO, sc);
+
+            // p - closest = ap - (sb * e1 + sc * e2)
+            const Float8 dxv = apx - MulAdd(sb, e1x, sc * e2x);
+            const Float8 dyv = apy - MulAdd(sb, e1y, sc * e2y);
+            const Float8 dzv = apz - MulAdd(sb, e1z, sc * e2z);
+            const Float8 distSq = Dot3(dxv, dyv, dzv, dxv, dyv, dzv);
+
+            const int bits = MoveMask(distSq <= Set1(radius * radius)) & LaneMask(block.count);
+            if (!bits) return 0;
+
+            const Float8 d = Sqrt(distSq);
+            const Float8 inv = ONE / d;
+            Store(out.dist, d);
+            Store(out.nx, dxv * inv);
+            Store(out.ny, dyv * inv);
+            Store(out.nz, dzv * inv);
+            return bits;
+        }
+    }
+
+    const TriangleKernels CP_TERRAIN_KERNELS_TABLE = { &RayBlock, &SphereBlock };
+
+} // namespace cp_api::physics
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "cp_api/physics/terrainCollision.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <cstdint>
+
+namespace cp_api {
+    class ThreadPool;
+    class DiagnosticsManager;
+}
+
+namespace cp_api::physics {
+
+    // ------------------------------------------------------------
+    // Streaming de colisão de terreno em tiles
+    // ------------------------------------------------------------
+
+    struct TerrainTileCoord {
+        int32_t x = 0;
+        int32_t z = 0;
+
+        bool operator==(const TerrainTileCoord& o) const { return x == o.x && z == o.z; }
+
+        uint64_t Key() const {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(z);
+        }
+    };
+
+    struct TerrainStreamingConfig {
+        std::filesystem::path directory;            // onde ficam os tiles cozidos
+        float tileSize = 256.0f;                    // lado do tile no plano XZ (metros)
+        float residencyRadius = 1024.0f;            // tiles a essa distância de algum foco ficam residentes
+        float unloadMargin = 128.0f;                // histerese: descarrega só além de radius + margin
+        size_t memoryBudgetBytes = 256ull * 1024 * 1024;
+        size_t maxLoadsInFlight = 4;                // leituras/decodificações simultâneas no ThreadPool
+    };
+
+    /**
+     * @brief Streams terrain collision in square XZ tiles around a set of focus points.
+     *
+     * Tiles are cooked once to compressed files (CookTiles / CookTile) and, at runtime, read,
+     * decompressed and built into a TerrainCollider on the ThreadPool. Update() only polls
+     * finished loads and moves the ready colliders in, so FixedUpdate never blocks on I/O or
+     * tree construction. Resident tiles are kept within the residency radius and under the
+     * memory budget (farthest tiles are evicted first, and a finished load only gets in if it fits
+     * or displaces farther tiles); usage is reported to DiagnosticsManager. Tiles left out for
+     * budget reasons are not loaded again until a focus moves to another tile or usage drops.
+     * Tiles without a file are skipped until CookTile writes some tile; failed loads are retried
+     * with exponential backoff.
+     *
+     * Queries are routed to every resident tile whose bounds overlap the query; triangle ids in
+     * hits are local to the tile reported in the hit's tile coordinate.
+     */
+    class TerrainTileManager {
+    public:
+        TerrainTileManager(ThreadPool& pool, TerrainStreamingConfig config);
+        ~TerrainTileManager();
+
+        TerrainTileManager(const TerrainTileManager&) = delete;
+        TerrainTileManager& operator=(const TerrainTileManager&) = delete;
+
+        /**
+         * @brief Split an indexed mesh into tiles and write one cooked file per non-empty tile.
+         * Each triangle goes to the tile containing its centroid, so tile bounds may slightly
+         * exceed the tile square.
+         * @return Number of tiles written.
+         */
+        static size_t CookTiles(const std::filesystem::path& directory, float tileSize,
+                                std::span<const Vec3> vertices, std::span<const uint32_t> indices);
+
+        /// Escreve um único tile cozido (malha já local ao tile).
+        static void CookTile(const std::filesystem::path& file,
+                             std::span<const Vec3> vertices, std::span<const uint32_t> indices);
+
+        /// Lê, descomprime e constrói o collider de um tile cozido (roda nos workers).
+        static std::unique_ptr<TerrainCollider> LoadTile(const std::filesystem::path& file);
+
+        static std::filesystem::path TilePath(const std::filesystem::path& directory, TerrainTileCoord coord);
+
+        /**
+         * @brief Per-tick streaming step; call from FixedUpdate with the active players' positions.
+         * Swaps in finished loads, evicts tiles out of range or over budget and schedules new loads,
+         * nearest first. Never waits on the pool.
+         */
+        void Update(std::span<const Vec3> focusPoints);
+
+        /// Publica o uso de memória dos tiles residentes contra o orçamento.
+        void ReportDiagnostics(DiagnosticsManager& diagnostics) const;
+
+        // Consultas sobre os tiles residentes
+        bool CollideSphere(shapes3D::Sphere& s, Vec3& correctionOut);
+        bool CollideCapsule(shapes3D::Capsule& c, Vec3& correctionOut);
+        bool Raycast(const Vec3& origin, const Vec3& dir, float maxDist, RayHit3& outHit, TerrainTileCoord* outTile = nullptr);
+        bool SweepSphere(const Vec3& start, const Vec3& end, float radius, SweepHit3& outHit, TerrainTileCoord* outTile = nullptr);
+
+        TerrainTileCoord TileAt(const Vec3& p) const;
+        bool IsResident(TerrainTileCoord coord) const { return m_resident.count(coord.Key()) != 0; }
+
+        size_t GetResidentCount() const { return m_resident.size(); }
+        size_t GetPendingCount() const { return m_pending.size(); }
+        size_t GetMemoryUsage() const { return m_memoryUsage; }
+        const TerrainStreamingConfig& GetConfig() const { return m_config; }
+
+    private:
+        struct Tile {
+            TerrainTileCoord coord;
+            std::unique_ptr<TerrainCollider> collider;
+            AABB3 bounds;
+            size_t memory = 0;
+        };
+
+        struct PendingTile {
+            TerrainTileCoord coord;
+            std::future<std::unique_ptr<TerrainCollider>> future;
+        };
+
+        struct FailedLoad {
+            uint32_t attempts = 0;
+            std::chrono::steady_clock::time_point retryAt;
+        };
+
+        void refreshOverBudget(std::span<const Vec3> focusPoints);
+        void collectFinishedLoads(std::span<const Vec3> focusPoints);
+        // abre espaço para `memory` descartando residentes mais distantes que `distance`
+        bool makeRoom(size_t memory, float distance, std::span<const Vec3> focusPoints);
+        void evict(std::span<const Vec3> focusPoints);
+        void scheduleLoads(std::span<const Vec3> focusPoints);
+
+        // distância no plano XZ do foco mais próximo até o quadrado do tile
+        float distanceToTile(TerrainTileCoord coord, std::span<const Vec3> focusPoints) const;
+
+    private:
+        ThreadPool& m_pool;
+        TerrainStreamingConfig m_config;
+
+        std::unordered_map<uint64_t, Tile> m_resident;
+        std::unordered_map<uint64_t, PendingTile> m_pending;
+        std::unordered_set<uint64_t> m_missing;         // tiles sem arquivo: só tenta de novo após um CookTile
+        std::unordered_map<uint64_t, FailedLoad> m_failed; // leitura/decodificação falhou: espera o backoff
+        uint64_t m_cookGeneration = 0;                  // CookTile visto por último (limpa m_missing)
+        // fora por orçamento (chave -> memória): não reagenda até o foco mudar de tile ou o uso
+        // cair o bastante, senão carrega, descarta e carrega de novo a cada tick
+        std::unordered_map<uint64_t, size_t> m_overBudget;
+        std::vector<uint64_t> m_focusTiles;             // tiles dos focos no último Update
+        size_t m_memoryUsage = 0;
+    };
+}
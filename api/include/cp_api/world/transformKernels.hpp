@@ -0,0 +1,41 @@
+#pragma once
+
+// Sem glm nem std além do básico: este header entra nos TUs compilados com AVX2.
+#include "cp_api/core/simd.hpp"
+
+#include <cstdint>
+
+namespace cp_api {
+
+    /// Bloco SoA de 8 transforms (TransformStore::Block). Matrizes 4x3 [col * 3 + row].
+    struct TransformBlock {
+        static constexpr uint32_t Width = simd::Width;
+
+        // entrada
+        alignas(32) float pos[3][Width];
+        alignas(32) float rot[4][Width];   // x, y, z, w
+        alignas(32) float scale[3][Width];
+        alignas(32) float center[3][Width];  // bounds locais como centro/extents
+        alignas(32) float extents[3][Width];
+
+        // saída (ComposeBlocks / ComposeWorld)
+        alignas(32) float local[12][Width];
+        alignas(32) float world[12][Width]; // só lanes com pai
+        alignas(32) float boundsMin[3][Width]; // bounds de mundo que a árvore conhece
+        alignas(32) float boundsMax[3][Width];
+    };
+
+    /**
+     * @brief Kernels of one ISA variant; GetTransformKernels() picks the best one for this CPU.
+     */
+    struct TransformKernels {
+        /// TRS -> 4x3 local (T * R * S) e bounds locais -> AABB de mundo, 8 lanes de uma vez.
+        void (*composeBlock)(TransformBlock& b, float (&outMin)[3][simd::Width], float (&outMax)[3][simd::Width]);
+    };
+
+    extern const TransformKernels TransformKernelsBaseline; // ISA padrão do build (SSE2 no x64)
+    extern const TransformKernels TransformKernelsAVX2;     // só existe com CP_SIMD_HAS_AVX2_KERNELS
+
+    const TransformKernels& GetTransformKernels();
+
+} // namespace cp_api
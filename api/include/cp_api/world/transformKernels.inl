@@ -0,0 +1,53 @@
+// Corpo dos kernels de transform, incluído uma vez por ISA (transformKernels.cpp,
+// transformKernelsAVX2.cpp). Quem inclui define CP_TRANSFORM_KERNELS_TABLE.
+#include "cp_api/world/transformKernels.hpp"
+
+namespace cp_api {
+    namespace {
+        using namespace simd;
+
+        // Matriz de rotação (linha, coluna) de 8 quaternions (supostos normalizados), como glm::mat3_cast.
+        void RotationMatrix(const TransformBlock& b, Float8 (&r)[3][3]) {
+            const Float8 x = Load(b.rot[0]), y = Load(b.rot[1]), z = Load(b.rot[2]), w = Load(b.rot[3]);
+            const Float8 one = Set1(1.0f), two = Set1(2.0f);
+
+            const Float8 xx = x * x, yy = y * y, zz = z * z;
+            const Float8 xy = x * y, xz = x * z, yz = y * z;
+            const Float8 wx = w * x, wy = w * y, wz = w * z;
+
+            r[0][0] = one - two * (yy + zz); r[0][1] = two * (xy - wz);       r[0][2] = two * (xz + wy);
+            r[1][0] = two * (xy + wz);       r[1][1] = one - two * (xx + zz); r[1][2] = two * (yz - wx);
+            r[2][0] = two * (xz - wy);       r[2][1] = two * (yz + wx);       r[2][2] = one - two * (xx + yy);
+        }
+
+        void ComposeBlock(TransformBlock& b, float (&outMin)[3][Width], float (&outMax)[3][Width]) {
+            Float8 m[3][3]; // R * S, (linha, coluna)
+            RotationMatrix(b, m);
+
+            for (int col = 0; col < 3; ++col) {
+                const Float8 s = Load(b.scale[col]);
+                for (int row = 0; row < 3; ++row) {
+                    m[row][col] = m[row][col] * s;
+                    Store(b.local[col * 3 + row], m[row][col]);
+                }
+            }
+
+            const Float8 c[3] = { Load(b.center[0]), Load(b.center[1]), Load(b.center[2]) };
+            const Float8 e[3] = { Load(b.extents[0]), Load(b.extents[1]), Load(b.extents[2]) };
+
+            for (int row = 0; row < 3; ++row) {
+                const Float8 p = Load(b.pos[row]);
+                Store(b.local[9 + row], p);
+
+                // centro transformado; extents pelo valor absoluto da base (AABB da caixa girada)
+                const Float8 wc = MulAdd(m[row][0], c[0], MulAdd(m[row][1], c[1], MulAdd(m[row][2], c[2], p)));
+                const Float8 we = MulAdd(Abs(m[row][0]), e[0], MulAdd(Abs(m[row][1]), e[1], Abs(m[row][2]) * e[2]));
+                Store(outMin[row], wc - we);
+                Store(outMax[row], wc + we);
+            }
+        }
+    }
+
+    const TransformKernels CP_TRANSFORM_KERNELS_TABLE = { &ComposeBlock };
+
+} // namespace cp_api
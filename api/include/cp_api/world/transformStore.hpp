@@ -0,0 +1,104 @@
+#pragma once
+
+#include "cp_api/core/math.hpp"
+#include "cp_api/core/simd.hpp"
+#include "cp_api/world/transformKernels.hpp"
+#include "cp_api/physics/aabb.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace cp_api {
+
+    /**
+     * @brief Transforms do World em blocos SoA de 8 lanes; TransformComponent guarda só o slot.
+     *
+     * Raízes usam a matriz local como de mundo; só lanes com pai têm `world` (ComposeWorld).
+     * ComposeBlocks/ComposeWorld podem rodar em paralelo em blocos/slots disjuntos; o resto não.
+     */
+    class TransformStore {
+    public:
+        static constexpr uint32_t Width = simd::Width;
+        static constexpr uint32_t InvalidSlot = UINT32_MAX;
+
+        using Block = TransformBlock;
+
+        struct BoundsChange {
+            uint32_t id;
+            physics3D::AABB oldBounds;
+            physics3D::AABB newBounds;
+        };
+
+        /// Ocupa um slot e já calcula matriz/bounds dele, para inserir na árvore na hora.
+        uint32_t Allocate(uint32_t entity, const Vec3& position, const Quat& rotation, const Vec3& scale,
+                          const physics3D::AABB& localBounds);
+        void Release(uint32_t slot);
+
+        Vec3 GetPosition(uint32_t slot) const {
+            const Block& b = block(slot); const uint32_t l = lane(slot);
+            return Vec3(b.pos[0][l], b.pos[1][l], b.pos[2][l]);
+        }
+        Quat GetRotation(uint32_t slot) const {
+            const Block& b = block(slot); const uint32_t l = lane(slot);
+            return Quat(b.rot[3][l], b.rot[0][l], b.rot[1][l], b.rot[2][l]);
+        }
+        Vec3 GetScale(uint32_t slot) const {
+            const Block& b = block(slot); const uint32_t l = lane(slot);
+            return Vec3(b.scale[0][l], b.scale[1][l], b.scale[2][l]);
+        }
+        physics3D::AABB GetLocalBounds(uint32_t slot) const;
+        physics3D::AABB GetWorldBounds(uint32_t slot) const;
+
+        void SetPosition(uint32_t slot, const Vec3& value);
+        void SetRotation(uint32_t slot, const Quat& value);
+        void SetScale(uint32_t slot, const Vec3& value);
+        void SetLocalBounds(uint32_t slot, const physics3D::AABB& bounds);
+
+        Mat4 GetLocalMatrix(uint32_t slot) const { return toMat4(block(slot).local, lane(slot)); }
+        Mat4 GetWorldMatrix(uint32_t slot) const {
+            return toMat4(IsRoot(slot) ? block(slot).local : block(slot).world, lane(slot));
+        }
+
+        uint32_t GetEntity(uint32_t slot) const { return m_entities[slot]; }
+        bool IsLive(uint32_t slot) const { return slot < GetSlotCount() && (m_live[slot / Width] >> lane(slot)) & 1u; }
+
+        void MarkDirty(uint32_t slot) { m_dirty[slot / Width] |= uint8_t(1u << lane(slot)); }
+        bool IsDirty(uint32_t slot) const { return (m_dirty[slot / Width] >> lane(slot)) & 1u; }
+        void ClearDirty();
+
+        /// Sem pai: a matriz de mundo é a local.
+        void SetRoot(uint32_t slot, bool root);
+        bool IsRoot(uint32_t slot) const { return (m_root[slot / Width] >> lane(slot)) & 1u; }
+
+        /// Algum TransformComponent trocou de pai desde a última chamada.
+        void MarkHierarchyChanged() { m_hierarchyChanged = true; }
+        bool ConsumeHierarchyChanged() { const bool changed = m_hierarchyChanged; m_hierarchyChanged = false; return changed; }
+
+        size_t GetSlotCount() const { return m_blocks.size() * Width; }
+        size_t GetBlockCount() const { return m_blocks.size(); }
+        size_t GetLiveCount() const { return GetSlotCount() - m_freeSlots.size(); }
+
+        /// Matrizes locais dos blocos sujos em [begin, end) e bounds das raízes sujas; não limpa os flags.
+        void ComposeBlocks(size_t begin, size_t end, std::vector<BoundsChange>& outChanges);
+
+        /// world(slot) = world(parentSlot) * local(slot), e as bounds de mundo a partir dela.
+        void ComposeWorld(uint32_t slot, uint32_t parentSlot, std::vector<BoundsChange>& outChanges);
+
+    private:
+        Block& block(uint32_t slot) { return m_blocks[slot / Width]; }
+        const Block& block(uint32_t slot) const { return m_blocks[slot / Width]; }
+        static uint32_t lane(uint32_t slot) { return slot % Width; }
+
+        static Mat4 toMat4(const float (&m)[12][Width], uint32_t lane);
+        void composeLane(uint32_t slot);
+
+        std::vector<Block> m_blocks;
+        std::vector<uint8_t> m_live;  // máscaras de lanes por bloco
+        std::vector<uint8_t> m_dirty;
+        std::vector<uint8_t> m_root;
+        std::vector<uint32_t> m_entities;
+        std::vector<uint32_t> m_freeSlots;
+        bool m_hierarchyChanged = false;
+    };
+
+} // namespace cp_api
@@ -2,11 +2,19 @@
 
 #include <entt/entt.hpp>
 #include "cp_api/physics/spatialTree3D.hpp"
+#include "cp_api/world/transformStore.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 namespace cp_api {
+    class ThreadPool;
+
     class World {
     public:
-        World();
+        /// Com `threadPool`, SyncTransforms recalcula as bounds em paralelo.
+        explicit World(ThreadPool* threadPool = nullptr);
         ~World();
 
         World(const World&) = delete;
@@ -17,14 +25,55 @@ namespace cp_api {
         void Update(const double& delta);
         void FixedUpdate(const double& delta);
 
+        /**
+         * @brief Recomputes the bounds of every dirty TransformComponent and feeds the changes
+         * to the world SpatialTree3D with one UpdateMany. Call once per frame after gameplay has
+         * moved things and before anything queries the tree (culling, physics).
+         *
+         * Local matrices, and world matrices and bounds of roots, come from the TransformStore
+         * SIMD kernels (8 transforms per step, blocks in parallel). Children are then composed
+         * with their parents over the flat hierarchy, sorted by depth (parents before children)
+         * and processed one level at a time, and their bounds are taken from the composed world
+         * matrix; only dirty transforms and their subtrees are touched.
+         * @return Number of transforms whose bounds changed.
+         */
+        size_t SyncTransforms();
+
         entt::registry& GetRegistry() { return m_registry; }
         SpatialTree3D& GetWorldSpace() { return m_worldSpace; }
+        TransformStore& GetTransformStore() { return m_transforms; }
     private:
         void setupCallbacks();
+        void rebuildHierarchy();
+        void propagateHierarchy();
         void onTransformAddCallback(entt::registry& reg, entt::entity e);
         void onTransformRemovedCallback(entt::registry& reg, entt::entity e);
     private:
         entt::registry m_registry;
         SpatialTree3D m_worldSpace;
+        TransformStore m_transforms;
+        ThreadPool* m_threadPool;
+
+        // SyncTransforms: um buffer por faixa de blocos (a tarefa dona da faixa escreve), reaproveitados
+        static constexpr size_t SyncChunkBlocks = 64;
+        std::vector<std::vector<TransformStore::BoundsChange>> m_syncBuffers;
+        std::vector<uint32_t> m_syncIds;
+        std::vector<std::pair<physics3D::AABB, physics3D::AABB>> m_syncBounds;
+
+        // hierarquia achatada: ordenada por profundidade, pais sempre antes dos filhos
+        static constexpr uint32_t NoParent = UINT32_MAX;
+        // (só transforms com pai; as raízes já saem prontas do ComposeBlocks)
+        struct HierarchyNode {
+            uint32_t slot;
+            uint32_t parent; // slot do pai no TransformStore
+        };
+        std::vector<HierarchyNode> m_hierarchy;
+        std::vector<size_t> m_levelOffsets;  // profundidade L + 1 = [m_levelOffsets[L], m_levelOffsets[L + 1])
+        std::vector<uint32_t> m_parentSlots; // por slot, da última reconstrução
+        std::vector<uint32_t> m_worldStamp;  // por slot: sync em que a matriz de mundo mudou (lida pelos filhos)
+        static constexpr size_t HierarchyChunk = 512;
+        std::vector<std::vector<TransformStore::BoundsChange>> m_hierarchyBuffers; // bounds dos filhos, por faixa
+        uint32_t m_syncFrame = 0;
+        bool m_hierarchyDirty = true;
     };
 } // namespace cp_api 
\ No newline at end of file
@@ -1 +1,250 @@
-#include "cp_api/core/events.hpp"
\ No newline at end of file
+#include "cp_api/core/events.hpp"
+#include "cp_api/core/threadPool.hpp"
+#include "cp_api/core/debug.hpp"
+
+#include <bit>
+#include <chrono>
+#include <thread>
+
+namespace cp_api {
+
+    namespace {
+        // profundidade de despacho assíncrono na thread (listener enfileirando mais eventos)
+        thread_local uint32_t t_asyncDepth = 0;
+
+        uint64_t NowNs() {
+            using namespace std::chrono;
+            return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+        }
+
+        size_t LatencyBucket(uint64_t ns) {
+            const uint64_t us = ns / 1000;
+            return std::min<size_t>(std::bit_width(us), AsyncDispatchStats::LatencyBucketCount - 1);
+        }
+
+        uint64_t MixKey(EventTypeID type, uint64_t key) {
+            uint64_t x = key ^ (static_cast<uint64_t>(type) * 0x9E3779B97F4A7C15ull);
+            x ^= x >> 33;
+            x *= 0xFF51AFD7ED558CCDull;
+            x ^= x >> 33;
+            return x;
+        }
+    }
+
+    // ---------------------------
+    // Estado do modo assíncrono
+    // ---------------------------
+    // Fila serial: no máximo uma tarefa de drenagem no pool por vez.
+    struct EventDispatcher::AsyncStrand {
+        explicit AsyncStrand(size_t capacity) : queue(capacity) {}
+
+        MPMCQueue<AsyncJob> queue;
+        alignas(64) std::atomic<bool> scheduled{ false };
+    };
+
+    struct EventDispatcher::AsyncState {
+        static constexpr size_t DrainBudget = 64; // eventos por tarefa antes de ceder o worker
+
+        AsyncState(ThreadPool& pool, const AsyncDispatchConfig& config) : pool(pool), config(config) {}
+
+        ThreadPool& pool;
+        AsyncDispatchConfig config;
+        std::vector<std::unique_ptr<AsyncStrand>> strands;
+
+        alignas(64) std::atomic<size_t> pending{ 0 };
+        std::atomic<bool> accepting{ true };
+        std::atomic<uint32_t> waiters{ 0 }; // produtores parados no backpressure
+        std::atomic<uint32_t> drains{ 0 };  // tarefas de drenagem no pool (StopAsync espera todas)
+
+        alignas(64) std::atomic<uint64_t> queued{ 0 };
+        std::atomic<uint64_t> dispatched{ 0 };
+        std::atomic<uint64_t> dropped{ 0 };
+        std::atomic<uint64_t> stalls{ 0 };
+        std::atomic<size_t> maxPending{ 0 };
+        std::array<std::atomic<uint64_t>, AsyncDispatchStats::LatencyBucketCount> latency{};
+    };
+
+    EventDispatcher::EventDispatcher() : m_nextListenerID(1) {}
+
+    EventDispatcher::~EventDispatcher() {
+        StopAsync();
+    }
+
+    void EventDispatcher::StartAsync(ThreadPool& pool, const AsyncDispatchConfig& config) {
+        if (m_async.load(std::memory_order_relaxed))
+            CP_LOG_THROW("[EventDispatcher] StartAsync called twice");
+
+        const size_t maxPending = std::max<size_t>(1, config.maxPending);
+        const size_t strandCount = config.strandCount ? config.strandCount : std::max<size_t>(1, pool.GetWorkerCount());
+
+        // produtores atrasados do ciclo anterior ainda podem ler o estado parado (m_async é nulo,
+        // então ninguém novo entra nele): espera saírem antes de mexer
+        while (m_asyncProducers.load(std::memory_order_seq_cst) != 0)
+            std::this_thread::yield();
+
+        AsyncState* async = m_asyncState.get();
+        if (async && &async->pool == &pool && async->strands.size() == strandCount && async->config.maxPending == maxPending) {
+            // mesmo pool e mesmos strands (vazios depois do StopAsync): só zera os contadores
+            async->queued.store(0, std::memory_order_relaxed);
+            async->dispatched.store(0, std::memory_order_relaxed);
+            async->dropped.store(0, std::memory_order_relaxed);
+            async->stalls.store(0, std::memory_order_relaxed);
+            async->maxPending.store(0, std::memory_order_relaxed);
+            for (auto& bucket : async->latency)
+                bucket.store(0, std::memory_order_relaxed);
+        } else {
+            m_asyncState = std::make_unique<AsyncState>(pool, config);
+            async = m_asyncState.get();
+
+            // cada strand comporta o limite inteiro: com a vaga reservada em `pending`, o push nunca falha
+            for (size_t i = 0; i < strandCount; ++i)
+                async->strands.push_back(std::make_unique<AsyncStrand>(maxPending));
+        }
+        async->config = config;
+        async->config.maxPending = maxPending;
+
+        async->accepting.store(true, std::memory_order_release);
+        m_async.store(async, std::memory_order_seq_cst);
+    }
+
+    void EventDispatcher::StopAsync() {
+        AsyncState* state = m_async.load(std::memory_order_acquire);
+        if (!state) return;
+
+        // par do recheck em postAsync: ou o produtor vê accepting == false, ou nós vemos a vaga dele
+        AsyncState& async = *state;
+        async.accepting.store(false, std::memory_order_seq_cst);
+        async.pool.WaitUntil([&] {
+            return async.pending.load(std::memory_order_seq_cst) == 0 && async.drains.load(std::memory_order_acquire) == 0;
+        });
+        // não libera: produtores atrasados ainda podem estar lendo (StartAsync espera por eles)
+        m_async.store(nullptr, std::memory_order_seq_cst);
+    }
+
+    bool EventDispatcher::asyncFanOut() const {
+        const AsyncState* async = m_async.load(std::memory_order_acquire);
+        return async && async->config.fanOutListeners;
+    }
+
+    bool EventDispatcher::postAsync(AsyncState& async, AsyncJob&& job, EventTypeID type, uint64_t orderKey) {
+        if (!async.accepting.load(std::memory_order_acquire)) {
+            async.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // reserva uma vaga; acima do limite, espera ajudando o pool (ou descarta)
+        size_t current = async.pending.load(std::memory_order_relaxed);
+        for (;;) {
+            if (current < async.config.maxPending) {
+                if (async.pending.compare_exchange_weak(current, current + 1, std::memory_order_seq_cst))
+                    break;
+                continue;
+            }
+
+            if (async.config.dropWhenFull || t_asyncDepth > 0) {
+                async.dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            async.stalls.fetch_add(1, std::memory_order_relaxed);
+            async.waiters.fetch_add(1, std::memory_order_seq_cst);
+            async.pool.WaitUntil([&] { return async.pending.load(std::memory_order_acquire) < async.config.maxPending; });
+            async.waiters.fetch_sub(1, std::memory_order_relaxed);
+            current = async.pending.load(std::memory_order_relaxed);
+        }
+
+        // StopAsync pode ter começado depois do primeiro teste: com a vaga já visível, ou ele
+        // espera por este evento, ou devolvemos a vaga e descartamos
+        if (!async.accepting.load(std::memory_order_seq_cst)) {
+            async.pending.fetch_sub(1, std::memory_order_acq_rel);
+            async.pool.NotifyWaiters();
+            async.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        size_t seen = async.maxPending.load(std::memory_order_relaxed);
+        while (current + 1 > seen && !async.maxPending.compare_exchange_weak(seen, current + 1, std::memory_order_relaxed)) {}
+
+        AsyncStrand& strand = *async.strands[MixKey(type, orderKey) % async.strands.size()];
+        job.enqueueNs = NowNs();
+        const bool pushed = strand.queue.TryPush(std::move(job));
+        (void)pushed; // sempre cabe (vaga reservada)
+        async.queued.fetch_add(1, std::memory_order_relaxed);
+
+        // par do fence em drainStrand: ou a drenagem vê o evento, ou nós vemos scheduled == false
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!strand.scheduled.exchange(true, std::memory_order_acq_rel))
+            scheduleDrain(async, strand);
+        return true;
+    }
+
+    void EventDispatcher::scheduleDrain(AsyncState& async, AsyncStrand& strand) {
+        async.drains.fetch_add(1, std::memory_order_relaxed);
+        async.pool.Dispatch(TaskPriority::NORMAL, [this, &async, &strand] { drainStrand(async, strand); });
+    }
+
+    void EventDispatcher::drainStrand(AsyncState& async, AsyncStrand& strand) {
+        ThreadPool& pool = async.pool;
+
+        ++t_asyncDepth;
+        AsyncJob job;
+        for (size_t n = 0; n < AsyncState::DrainBudget && strand.queue.TryPop(job); ++n) {
+            async.latency[LatencyBucket(NowNs() - job.enqueueNs)].fetch_add(1, std::memory_order_relaxed);
+            job.Run(*this);
+            job = AsyncJob();
+
+            async.dispatched.fetch_add(1, std::memory_order_relaxed);
+            async.pending.fetch_sub(1, std::memory_order_acq_rel);
+            if (async.waiters.load(std::memory_order_seq_cst) > 0)
+                pool.NotifyWaiters();
+        }
+        --t_asyncDepth;
+
+        strand.scheduled.store(false, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // sobrou (orçamento esgotado ou chegou depois): nova tarefa, para não segurar o worker
+        if (!strand.queue.Empty() && !strand.scheduled.exchange(true, std::memory_order_acq_rel))
+            scheduleDrain(async, strand);
+
+        // depois disso StopAsync pode retornar (o estado fica para o próximo StartAsync)
+        async.drains.fetch_sub(1, std::memory_order_acq_rel);
+        pool.NotifyWaiters();
+    }
+
+    void EventDispatcher::fanOut(size_t count, void (*run)(const void* ctx, size_t index), const void* ctx) {
+        // só roda dentro de uma drenagem: StopAsync ainda não zerou m_async
+        ThreadPool& pool = m_async.load(std::memory_order_acquire)->pool;
+
+        TaskCounter counter;
+        for (size_t i = 1; i < count; ++i)
+            pool.Dispatch(TaskPriority::NORMAL, counter, [run, ctx, i] {
+                ++t_asyncDepth; // também não pode esperar pelo backpressure: o strand espera por ela
+                run(ctx, i);
+                --t_asyncDepth;
+            });
+        run(ctx, 0);
+        pool.Wait(counter);
+    }
+
+    AsyncDispatchStats EventDispatcher::GetAsyncStats(bool reset) {
+        AsyncDispatchStats stats;
+        AsyncState* state = m_async.load(std::memory_order_acquire);
+        if (!state) return stats;
+
+        AsyncState& async = *state;
+        const auto read = [reset](auto& counter) {
+            return reset ? counter.exchange(0, std::memory_order_relaxed) : counter.load(std::memory_order_relaxed);
+        };
+
+        stats.queued = read(async.queued);
+        stats.dispatched = read(async.dispatched);
+        stats.dropped = read(async.dropped);
+        stats.backpressureStalls = read(async.stalls);
+        stats.maxPending = read(async.maxPending);
+        stats.pending = async.pending.load(std::memory_order_relaxed);
+        for (size_t b = 0; b < AsyncDispatchStats::LatencyBucketCount; ++b)
+            stats.latency[b] = read(async.latency[b]);
+        return stats;
+    }
+
+} // namespace cp_api
@@ -0,0 +1,111 @@
+#include "cp_api/core/frameArena.hpp"
+
+#include <algorithm>
+#include <new>
+
+namespace cp_api {
+
+    namespace {
+        thread_local FrameArena* t_currentArena = nullptr;
+
+        size_t AlignUp(size_t value, size_t alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    FrameArena::FrameArena(size_t chunkSize)
+        : m_chunkSize(std::max<size_t>(chunkSize, 1024)) {}
+
+    FrameArena::~FrameArena() {
+        for (Chunk& chunk : m_chunks)
+            ::operator delete(chunk.data, std::align_val_t{ alignof(std::max_align_t) });
+    }
+
+    void FrameArena::Reset() {
+        m_chunk = 0;
+        m_offset = 0;
+    }
+
+    void FrameArena::Rewind(Marker marker) {
+        // marcador de antes de um Reset (frame anterior): não volta para a frente
+        if (marker.chunk > m_chunk || (marker.chunk == m_chunk && marker.offset > m_offset))
+            return;
+        m_chunk = marker.chunk;
+        m_offset = marker.offset;
+    }
+
+    size_t FrameArena::GetUsedBytes() const {
+        size_t used = m_offset;
+        for (size_t i = 0; i < m_chunk && i < m_chunks.size(); ++i)
+            used += m_chunks[i].size;
+        return used;
+    }
+
+    void FrameArena::checkEpoch() {
+        // com um Scope aberto o frame anterior ainda está em uso: adia até o último fechar
+        if (!m_epochSource || m_scopeDepth > 0) return;
+        const uint64_t epoch = m_epochSource->load(std::memory_order_relaxed);
+        if (epoch != m_epoch) {
+            m_epoch = epoch;
+            Reset();
+        }
+    }
+
+    void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+        checkEpoch();
+
+        for (;;) {
+            if (m_chunk < m_chunks.size()) {
+                Chunk& chunk = m_chunks[m_chunk];
+                const size_t begin = AlignUp(reinterpret_cast<uintptr_t>(chunk.data) + m_offset, alignment)
+                                   - reinterpret_cast<uintptr_t>(chunk.data);
+                if (begin + bytes <= chunk.size) {
+                    m_offset = begin + bytes;
+                    m_highWater = std::max(m_highWater, GetUsedBytes());
+                    return chunk.data + begin;
+                }
+
+                // não coube: tenta o próximo chunk (os já alocados são reaproveitados em ordem)
+                if (m_chunk + 1 < m_chunks.size() && m_chunks[m_chunk + 1].size >= bytes + alignment) {
+                    ++m_chunk;
+                    m_offset = 0;
+                    continue;
+                }
+            }
+
+            // chunk novo logo depois do atual; pedidos grandes ganham um chunk do tamanho deles
+            Chunk chunk;
+            chunk.size = std::max(m_chunkSize, AlignUp(bytes + alignment, 4096));
+            chunk.data = static_cast<std::byte*>(::operator new(chunk.size, std::align_val_t{ alignof(std::max_align_t) }));
+            m_capacity += chunk.size;
+
+            const size_t at = m_chunks.empty() ? 0 : std::min(m_chunk + 1, m_chunks.size());
+            m_chunks.insert(m_chunks.begin() + at, chunk);
+            m_chunk = at;
+            m_offset = 0;
+        }
+    }
+
+    void FrameArena::do_deallocate(void* ptr, size_t bytes, size_t) {
+        // só o topo volta na hora (crescimento de vector, temporários LIFO)
+        if (m_chunk < m_chunks.size()) {
+            std::byte* top = m_chunks[m_chunk].data + m_offset;
+            if (static_cast<std::byte*>(ptr) + bytes == top)
+                m_offset -= bytes;
+        }
+    }
+
+    FrameArena* FrameArena::Current() {
+        return t_currentArena;
+    }
+
+    void FrameArena::SetCurrent(FrameArena* arena) {
+        t_currentArena = arena;
+    }
+
+    std::pmr::memory_resource* FrameArena::CurrentResource() {
+        FrameArena* arena = t_currentArena;
+        return arena ? static_cast<std::pmr::memory_resource*>(arena) : std::pmr::new_delete_resource();
+    }
+
+} // namespace cp_api
@@ -0,0 +1,145 @@
+#include "cp_api/core/jobGraph.hpp"
+#include "cp_api/core/debug.hpp"
+
+namespace cp_api {
+
+    JobGraph::~JobGraph() {
+        // os jobs capturam `this`: não pode sair de escopo com a execução em andamento
+        if (IsRunning()) {
+            try { Wait(); } catch (...) {}
+        }
+    }
+
+    JobGraph::NodeId JobGraph::AddNode(std::string name, std::function<void()> job, TaskPriority priority) {
+        if (IsRunning())
+            CP_LOG_THROW("[JobGraph] AddNode('{}') while the graph is running", name);
+
+        Node node;
+        node.name = std::move(name);
+        node.job = std::move(job);
+        node.priority = priority;
+        m_nodes.push_back(std::move(node));
+        m_validated = false;
+        return static_cast<NodeId>(m_nodes.size() - 1);
+    }
+
+    void JobGraph::AddDependency(NodeId before, NodeId after) {
+        if (IsRunning())
+            CP_LOG_THROW("[JobGraph] AddDependency while the graph is running");
+        if (before >= m_nodes.size() || after >= m_nodes.size() || before == after)
+            CP_LOG_THROW("[JobGraph] invalid dependency {} -> {} ({} nodes)", before, after, m_nodes.size());
+
+        m_nodes[before].successors.push_back(after);
+        m_nodes[after].dependencyCount++;
+        m_validated = false;
+    }
+
+    void JobGraph::Clear() {
+        if (IsRunning())
+            CP_LOG_THROW("[JobGraph] Clear while the graph is running");
+
+        m_nodes.clear();
+        m_roots.clear();
+        m_pending.reset();
+        m_validated = false;
+    }
+
+    void JobGraph::validate() {
+        const size_t count = m_nodes.size();
+
+        // Kahn: se não visitar todos os nós, há ciclo
+        std::vector<uint32_t> indegree(count);
+        std::vector<NodeId> ready;
+        for (size_t i = 0; i < count; ++i) {
+            indegree[i] = m_nodes[i].dependencyCount;
+            if (indegree[i] == 0) ready.push_back(static_cast<NodeId>(i));
+        }
+
+        m_roots = ready;
+
+        size_t visited = 0;
+        while (!ready.empty()) {
+            NodeId id = ready.back();
+            ready.pop_back();
+            ++visited;
+            for (NodeId succ : m_nodes[id].successors)
+                if (--indegree[succ] == 0) ready.push_back(succ);
+        }
+
+        if (visited != count)
+            CP_LOG_THROW("[JobGraph] dependency cycle detected ({} of {} nodes reachable)", visited, count);
+
+        m_pending.reset(new std::atomic<uint32_t>[count]);
+        m_validated = true;
+    }
+
+    void JobGraph::Run(ThreadPool& pool) {
+        if (IsRunning())
+            CP_LOG_THROW("[JobGraph] Run while the previous execution is still running");
+        if (m_nodes.empty())
+            return;
+        if (!m_validated)
+            validate();
+
+        m_pool = &pool;
+        m_error = nullptr;
+        for (size_t i = 0; i < m_nodes.size(); ++i)
+            m_pending[i].store(m_nodes[i].dependencyCount, std::memory_order_relaxed);
+        m_remaining.store(static_cast<uint32_t>(m_nodes.size()), std::memory_order_release);
+        m_running.store(true, std::memory_order_release);
+
+        for (NodeId root : m_roots)
+            dispatch(root);
+    }
+
+    void JobGraph::Wait() {
+        // ajuda o pool em vez de bloquear: funciona de dentro de um job, no worker 0 (main
+        // thread) e com um worker só
+        if (IsRunning())
+            m_pool->WaitUntil([this] { return !IsRunning(); });
+
+        // o último job zera m_running sob o mutex: passando por ele, ninguém mais toca no grafo
+        { std::lock_guard<std::mutex> lock(m_doneMutex); }
+
+        if (IsRunning()) {
+            // o pool desistiu: foi desligado com nós ainda na fila (descartados)
+            m_running.store(false, std::memory_order_release);
+            CP_LOG_THROW("[JobGraph] thread pool shut down before the graph finished");
+        }
+
+        if (m_error) {
+            std::exception_ptr error = std::exchange(m_error, nullptr);
+            std::rethrow_exception(error);
+        }
+    }
+
+    void JobGraph::dispatch(NodeId id) {
+        m_pool->Dispatch(m_nodes[id].priority, [this, id] { execute(id); });
+    }
+
+    void JobGraph::execute(NodeId id) {
+        Node& node = m_nodes[id];
+
+        try {
+            if (node.job) node.job();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            if (!m_error) m_error = std::current_exception();
+        }
+
+        // continuações: quem zerar o contador de junção é despachado daqui (deque do worker)
+        for (NodeId succ : node.successors)
+            if (m_pending[succ].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                dispatch(succ);
+
+        if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ThreadPool* pool = m_pool; // o grafo pode ser destruído assim que o mutex for liberado
+            {
+                std::lock_guard<std::mutex> lock(m_doneMutex);
+                m_running.store(false, std::memory_order_release);
+            }
+            pool->NotifyWaiters();
+        }
+    }
+
+} // namespace cp_api
@@ -0,0 +1,34 @@
+#include "cp_api/core/simd.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
+namespace cp_api::simd {
+
+    bool HasAVX2() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int regs[4];
+        __cpuid(regs, 0);
+        if (regs[0] < 7) return false;
+
+        __cpuid(regs, 1);
+        const bool fma = (regs[2] & (1 << 12)) != 0;
+        const bool osxsave = (regs[2] & (1 << 27)) != 0;
+        const bool avx = (regs[2] & (1 << 28)) != 0;
+        if (!fma || !osxsave || !avx) return false;
+
+        // o SO precisa salvar os registradores YMM (XCR0: SSE + AVX)
+        if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        // já considera o suporte do SO (XCR0)
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+        return false;
+#endif
+    }
+
+} // namespace cp_api::simd
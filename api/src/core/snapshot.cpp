@@ -0,0 +1,114 @@
+#include "cp_api/core/snapshot.hpp"
+
+#include <algorithm>
+
+namespace cp_api {
+
+    // ---------------------------
+    // Épocas dos SnapshotCell
+    // ---------------------------
+    // Uma leitura ativa: (época << 16) | quantas leituras seguram essa época.
+    struct detail::SnapshotEpochs::Slot {
+        std::atomic<uint64_t> state{ 0 };
+    };
+
+    namespace {
+        constexpr uint64_t CountBits = 16;
+        constexpr uint64_t CountMask = (uint64_t(1) << CountBits) - 1;
+
+        using Slot = detail::SnapshotEpochs::Slot;
+
+        // Duas slots por thread: com leituras sobrepostas (uma começa antes de a anterior acabar)
+        // a época mais velha esvazia e é trocada pela atual, em vez de segurar tudo para sempre.
+        // Normalmente só a thread dona mexe nelas; um ReadGuard movido sai pela slot certa.
+        struct ThreadSlots {
+            alignas(64) Slot slots[2];
+            std::atomic<bool> inUse{ false };
+            ThreadSlots* next = nullptr; // lista só cresce; as de threads que saíram são reaproveitadas
+        };
+
+        std::atomic<uint64_t> g_epoch{ 1 };
+        std::atomic<ThreadSlots*> g_threads{ nullptr };
+
+        ThreadSlots* AcquireThreadSlots() {
+            for (ThreadSlots* t = g_threads.load(std::memory_order_acquire); t; t = t->next) {
+                bool expected = false;
+                if (!t->inUse.load(std::memory_order_relaxed) &&
+                    t->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                    return t;
+            }
+
+            // nunca liberada: o MinActive percorre a lista sem trava
+            ThreadSlots* t = new ThreadSlots;
+            t->inUse.store(true, std::memory_order_relaxed);
+            ThreadSlots* head = g_threads.load(std::memory_order_relaxed);
+            do {
+                t->next = head;
+            } while (!g_threads.compare_exchange_weak(head, t, std::memory_order_release, std::memory_order_relaxed));
+            return t;
+        }
+
+        struct LocalSlots {
+            ThreadSlots* slots = nullptr;
+
+            ~LocalSlots() {
+                if (slots) slots->inUse.store(false, std::memory_order_release);
+            }
+        };
+
+        thread_local LocalSlots t_slots;
+    }
+
+    detail::SnapshotEpochs::Slot* detail::SnapshotEpochs::EnterRead() {
+        LocalSlots& local = t_slots;
+        if (!local.slots) local.slots = AcquireThreadSlots();
+        Slot* slots = local.slots->slots;
+
+        // seq_cst aqui e no Retire: quem vê a época nova também vê a versão nova, e o anúncio
+        // (CAS) vem antes da leitura da versão. Entrar numa época mais velha só atrasa a reclamação.
+        for (;;) {
+            const uint64_t epoch = g_epoch.load(std::memory_order_seq_cst);
+            uint64_t state[2] = { slots[0].state.load(std::memory_order_relaxed),
+                                  slots[1].state.load(std::memory_order_relaxed) };
+
+            int pick = -1;
+            uint64_t next = 0;
+            for (int i = 0; i < 2 && pick < 0; ++i) {
+                if ((state[i] & CountMask) != 0 && (state[i] >> CountBits) == epoch) { pick = i; next = state[i] + 1; }
+            }
+            for (int i = 0; i < 2 && pick < 0; ++i) {
+                if ((state[i] & CountMask) == 0) { pick = i; next = (epoch << CountBits) | 1; }
+            }
+            if (pick < 0) {
+                // as duas seguram épocas antigas: junta-se à mais nova
+                pick = (state[0] >> CountBits) > (state[1] >> CountBits) ? 0 : 1;
+                next = state[pick] + 1;
+            }
+
+            if (slots[pick].state.compare_exchange_strong(state[pick], next, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return &slots[pick];
+        }
+    }
+
+    void detail::SnapshotEpochs::LeaveRead(Slot* slot) noexcept {
+        // release: as leituras da versão terminam antes de o escritor ver a slot livre
+        slot->state.fetch_sub(1, std::memory_order_release);
+    }
+
+    uint64_t detail::SnapshotEpochs::Retire() {
+        return g_epoch.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    uint64_t detail::SnapshotEpochs::MinActive() {
+        uint64_t minEpoch = UINT64_MAX;
+        for (ThreadSlots* t = g_threads.load(std::memory_order_acquire); t; t = t->next) {
+            for (const Slot& slot : t->slots) {
+                const uint64_t state = slot.state.load(std::memory_order_seq_cst);
+                if ((state & CountMask) != 0)
+                    minEpoch = std::min(minEpoch, state >> CountBits);
+            }
+        }
+        return minEpoch;
+    }
+
+} // namespace cp_api
@@ -0,0 +1,198 @@
+#include "cp_api/core/task.hpp"
+#include "cp_api/core/debug.hpp"
+#include "cp_api/core/filesystem.hpp"
+
+namespace cp_api {
+
+    // ---------------------------
+    // Frames de corrotina
+    // ---------------------------
+    namespace {
+        constexpr size_t MinClassShift = 6;  // 64 B
+        constexpr size_t MaxClassShift = 12; // 4 KiB
+        constexpr size_t ClassCount = MaxClassShift - MinClassShift + 1;
+        constexpr size_t LocalCacheLimit = 64; // por classe e por thread
+
+        struct FreeBlock { FreeBlock* next; };
+
+        size_t SizeClass(size_t size) {
+            size_t shift = MinClassShift;
+            while ((size_t(1) << shift) < size) ++shift;
+            return shift - MinClassShift;
+        }
+
+        // lista compartilhada: recebe o excesso das threads e as sobras de threads que saíram
+        struct SharedFrames {
+            std::mutex mutex;
+            FreeBlock* heads[ClassCount] = {};
+        };
+
+        SharedFrames& Shared() {
+            static SharedFrames shared;
+            return shared;
+        }
+
+        struct LocalFrames {
+            FreeBlock* heads[ClassCount] = {};
+            size_t counts[ClassCount] = {};
+
+            ~LocalFrames() {
+                SharedFrames& shared = Shared();
+                std::lock_guard<std::mutex> lock(shared.mutex);
+                for (size_t c = 0; c < ClassCount; ++c) {
+                    while (FreeBlock* block = heads[c]) {
+                        heads[c] = block->next;
+                        block->next = shared.heads[c];
+                        shared.heads[c] = block;
+                    }
+                }
+            }
+        };
+
+        thread_local LocalFrames t_frames;
+    }
+
+    void* detail::CoroutineFrameAllocator::Allocate(size_t size) {
+        if (size > (size_t(1) << MaxClassShift))
+            return ::operator new(size);
+
+        const size_t c = SizeClass(size);
+        LocalFrames& local = t_frames;
+
+        if (!local.heads[c]) {
+            // pega um lote da lista compartilhada antes de ir ao heap
+            SharedFrames& shared = Shared();
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            for (size_t i = 0; i < LocalCacheLimit / 2 && shared.heads[c]; ++i) {
+                FreeBlock* block = shared.heads[c];
+                shared.heads[c] = block->next;
+                block->next = local.heads[c];
+                local.heads[c] = block;
+                ++local.counts[c];
+            }
+        }
+
+        if (FreeBlock* block = local.heads[c]) {
+            local.heads[c] = block->next;
+            --local.counts[c];
+            return block;
+        }
+        return ::operator new(size_t(1) << (c + MinClassShift));
+    }
+
+    void detail::CoroutineFrameAllocator::Deallocate(void* ptr, size_t size) noexcept {
+        if (size > (size_t(1) << MaxClassShift)) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        const size_t c = SizeClass(size);
+        LocalFrames& local = t_frames;
+
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        block->next = local.heads[c];
+        local.heads[c] = block;
+
+        if (++local.counts[c] <= LocalCacheLimit)
+            return;
+
+        // cache cheio: devolve metade para as outras threads
+        SharedFrames& shared = Shared();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        while (local.counts[c] > LocalCacheLimit / 2) {
+            FreeBlock* spill = local.heads[c];
+            local.heads[c] = spill->next;
+            spill->next = shared.heads[c];
+            shared.heads[c] = spill;
+            --local.counts[c];
+        }
+    }
+
+    void detail::ThrowResumeCancelled() {
+        throw std::runtime_error("ThreadPool shut down before resuming the coroutine");
+    }
+
+    // ---------------------------
+    // FrameScheduler
+    // ---------------------------
+    void FrameScheduler::park(std::coroutine_handle<> handle, TaskPriority priority, bool* cancelled) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_parked.push_back({ handle, priority, cancelled });
+    }
+
+    void FrameScheduler::AdvanceFrame() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_resuming.swap(m_parked);
+            m_frameIndex.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        // quem voltar a esperar cai em m_parked e só acorda no próximo frame
+        size_t next = 0;
+        try {
+            for (; next < m_resuming.size(); ++next) {
+                const Parked& parked = m_resuming[next];
+                detail::PoolResume resume(parked.handle, parked.cancelled);
+                try {
+                    m_pool.Dispatch(parked.priority, std::move(resume));
+                } catch (...) {
+                    resume.Release();
+                    throw;
+                }
+            }
+        } catch (...) {
+            // pool parado: esta e as que faltam se desfazem agora, nada volta para m_parked
+            for (; next < m_resuming.size(); ++next)
+                detail::ResumeCancelled(m_resuming[next].handle, m_resuming[next].cancelled);
+            m_resuming.clear();
+            throw;
+        }
+        m_resuming.clear();
+    }
+
+    FrameScheduler::~FrameScheduler() {
+        std::vector<Parked> parked;
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                parked.swap(m_parked);
+            }
+            if (parked.empty())
+                break;
+            for (const Parked& p : parked)
+                detail::ResumeCancelled(p.handle, p.cancelled);
+            parked.clear();
+        }
+    }
+
+    size_t FrameScheduler::GetWaitingCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_parked.size();
+    }
+
+    // ---------------------------
+    // Helpers
+    // ---------------------------
+    Task<std::pair<std::shared_ptr<uint8_t[]>, std::span<const uint8_t>>>
+    ReadBytesAsync(ThreadPool& pool, std::filesystem::path path, TaskPriority resumeOn) {
+        co_await ScheduleOn{ pool, TaskPriority::BACKGROUND };
+        auto result = filesystem::ReadBytesAuto(path);
+        co_await ScheduleOn{ pool, resumeOn };
+        co_return result;
+    }
+
+    void Spawn(ThreadPool& pool, Task<void> task, TaskPriority priority) {
+        auto run = [](ThreadPool& pool, Task<void> task, TaskPriority priority) -> detail::DetachedTask {
+            try {
+                co_await ScheduleOn{ pool, priority };
+                co_await std::move(task);
+            } catch (const std::exception& e) {
+                CP_LOG_ERROR("[Task] unhandled exception in spawned task: {}", e.what());
+            } catch (...) {
+                CP_LOG_ERROR("[Task] unhandled exception in spawned task");
+            }
+        };
+        run(pool, std::move(task), priority);
+    }
+
+} // namespace cp_api
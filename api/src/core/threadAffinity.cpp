@@ -0,0 +1,161 @@
+#include "cp_api/core/threadAffinity.hpp"
+#include "cp_api/core/debug.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace cp_api {
+
+    namespace {
+        struct RawCpu {
+            uint32_t id;
+            uint64_t coreKey; // (pacote << 32) | núcleo: identifica o núcleo físico
+        };
+
+#ifdef _WIN32
+        std::vector<RawCpu> ReadTopology() {
+            std::vector<RawCpu> cpus;
+
+            DWORD length = 0;
+            GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length);
+            std::vector<uint8_t> buffer(length);
+            auto* info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+            if (length == 0 || !GetLogicalProcessorInformationEx(RelationProcessorCore, info, &length))
+                return cpus;
+
+            uint64_t core = 0;
+            for (DWORD offset = 0; offset < length; ++core) {
+                auto* entry = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+                const GROUP_AFFINITY& group = entry->Processor.GroupMask[0];
+                if (group.Group == 0) {
+                    for (uint32_t bit = 0; bit < 64; ++bit)
+                        if (group.Mask & (KAFFINITY(1) << bit))
+                            cpus.push_back({ bit, core });
+                }
+                offset += entry->Size;
+            }
+            return cpus;
+        }
+#else
+        bool ReadNumber(const std::string& path, uint64_t& out) {
+            std::ifstream in(path);
+            return static_cast<bool>(in >> out);
+        }
+
+        std::vector<RawCpu> ReadTopology() {
+            std::vector<RawCpu> cpus;
+
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+                return cpus;
+
+            for (uint32_t id = 0; id < CPU_SETSIZE; ++id) {
+                if (!CPU_ISSET(id, &allowed)) continue;
+
+                const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology/";
+                uint64_t core = 0, package = 0;
+                if (!ReadNumber(base + "core_id", core) || !ReadNumber(base + "physical_package_id", package)) {
+                    core = id; // sem sysfs: cada CPU lógica vira um núcleo
+                    package = UINT32_MAX;
+                }
+                cpus.push_back({ id, (package << 32) | core });
+            }
+            return cpus;
+        }
+#endif
+    }
+
+    CpuTopology::CpuTopology() {
+        std::vector<RawCpu> raw = ReadTopology();
+        if (raw.empty()) {
+            const uint32_t count = std::max(1u, std::thread::hardware_concurrency());
+            for (uint32_t id = 0; id < count; ++id)
+                raw.push_back({ id, id });
+        }
+
+        // núcleos na ordem da primeira CPU lógica de cada um
+        std::map<uint64_t, uint32_t> coreIndex;
+        for (const RawCpu& cpu : raw) {
+            auto [it, inserted] = coreIndex.try_emplace(cpu.coreKey, static_cast<uint32_t>(m_cores.size()));
+            if (inserted) m_cores.emplace_back();
+
+            LogicalCpu logical;
+            logical.id = cpu.id;
+            logical.core = it->second;
+            logical.smtIndex = static_cast<uint32_t>(m_cores[it->second].size());
+            m_cores[it->second].push_back(cpu.id);
+            m_cpus.push_back(logical);
+        }
+    }
+
+    const CpuTopology& CpuTopology::Get() {
+        static const CpuTopology topology;
+        return topology;
+    }
+
+    std::vector<uint32_t> CpuTopology::PlacementOrder(size_t skipCores, bool preferPhysical) const {
+        std::vector<uint32_t> order;
+        if (skipCores >= m_cores.size())
+            return order;
+
+        if (!preferPhysical) {
+            for (size_t c = skipCores; c < m_cores.size(); ++c)
+                order.insert(order.end(), m_cores[c].begin(), m_cores[c].end());
+            return order;
+        }
+
+        // uma por núcleo, depois as irmãs SMT
+        for (size_t smt = 0; order.size() < m_cpus.size(); ++smt) {
+            bool any = false;
+            for (size_t c = skipCores; c < m_cores.size(); ++c) {
+                if (smt < m_cores[c].size()) {
+                    order.push_back(m_cores[c][smt]);
+                    any = true;
+                }
+            }
+            if (!any) break;
+        }
+        return order;
+    }
+
+    bool SetCurrentThreadAffinity(std::span<const uint32_t> cpus) {
+        if (cpus.empty()) return false;
+
+#ifdef _WIN32
+        DWORD_PTR mask = 0;
+        for (uint32_t id : cpus)
+            if (id < sizeof(DWORD_PTR) * 8) mask |= DWORD_PTR(1) << id;
+        return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (uint32_t id : cpus)
+            if (id < CPU_SETSIZE) CPU_SET(id, &set);
+        const int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (result != 0)
+            CP_LOG_WARN("[Threading] pthread_setaffinity_np failed ({})", result);
+        return result == 0;
+#endif
+    }
+
+    void SetCurrentThreadName(const std::string& name) {
+#ifdef _WIN32
+        std::wstring wide(name.begin(), name.end());
+        SetThreadDescription(GetCurrentThread(), wide.c_str());
+#else
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#endif
+    }
+
+} // namespace cp_api
@@ -1,17 +1,103 @@
 #include "cp_api/core/threadPool.hpp"
+#include "cp_api/core/debug.hpp"
+#include "cp_api/core/threadAffinity.hpp"
 #include <iostream>
+#include <bit>
 
 namespace cp_api {
 
-ThreadPool::ThreadPool(size_t threadCount)
-    : m_running(true),
-      m_queues(threadCount),
-      m_mutexes(threadCount),
-      m_conditions(threadCount),
-      m_dist(0, threadCount - 1)
+namespace {
+    // worker da thread atual (nullptr fora dos pools)
+    thread_local const ThreadPool* t_pool = nullptr;
+    thread_local size_t t_workerIndex = SIZE_MAX;
+
+    // xorshift por thread para escolher a vítima do roubo (sem estado compartilhado)
+    thread_local uint64_t t_rngState = 0;
+
+    uint64_t NextRandom() {
+        uint64_t x = t_rngState;
+        if(x == 0) x = 0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(&t_rngState);
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        t_rngState = x;
+        return x;
+    }
+
+    // profundidade de RunTask na thread: tempo ocupado só é medido no nível externo
+    thread_local uint32_t t_runDepth = 0;
+
+    uint64_t NowNs() {
+        using namespace std::chrono;
+        return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+    }
+
+    size_t LatencyBucket(uint64_t ns) {
+        const uint64_t us = ns / 1000;
+        return std::min<size_t>(std::bit_width(us), ThreadPoolStats::LatencyBucketCount - 1);
+    }
+}
+
+ThreadPool::ThreadPool(size_t threadCount, size_t backgroundWorkers, bool mainThreadWorker)
+    : m_running(true)
+{
+    ThreadPoolConfig config;
+    config.workerCount = std::max<size_t>(1, threadCount);
+    config.backgroundWorkers = backgroundWorkers;
+    config.mainThreadWorker = mainThreadWorker;
+    Start(config);
+}
+
+ThreadPool::ThreadPool(const ThreadPoolConfig& config)
+    : m_running(true)
 {
+    Start(config);
+}
+
+void ThreadPool::Start(const ThreadPoolConfig& config) {
+    const CpuTopology& topology = CpuTopology::Get();
+    const size_t reserved = std::min(config.reservedCores, topology.GetPhysicalCount() - 1);
+    for(size_t c = 0; c < reserved; ++c)
+        for(uint32_t cpu : topology.GetCoreCpus(c))
+            m_reservedCpus.push_back(cpu);
+
+    const std::vector<uint32_t> placement = topology.PlacementOrder(reserved, config.preferPhysicalCores);
+
+    size_t threadCount = config.workerCount;
+    if(threadCount == 0) {
+        threadCount = config.preferPhysicalCores ? topology.GetPhysicalCount() - reserved : placement.size();
+        threadCount = std::max<size_t>(1, threadCount);
+    }
+
+    size_t backgroundWorkers = config.backgroundWorkers;
+    if(backgroundWorkers == 0) backgroundWorkers = std::max<size_t>(1, threadCount / 4);
+    m_backgroundLimit.store(backgroundWorkers, std::memory_order_relaxed);
+
+    m_mainThreadWorker = config.mainThreadWorker;
+    m_threadNamePrefix = config.threadNamePrefix;
+
+    for(auto& queue : m_injection)
+        queue = std::make_unique<MPMCQueue<TaskSlot*>>(4096);
+    m_background = std::make_unique<MPMCQueue<TaskSlot*>>(4096);
+
+    const size_t first = m_mainThreadWorker ? 1 : 0;
+    m_workerData.reserve(threadCount + first);
+    for(size_t i = 0; i < threadCount + first; ++i) {
+        m_workerData.push_back(std::make_unique<Worker>());
+        m_workerData.back()->arena.SetEpochSource(&m_frameEpoch);
+    }
+
+    // mais workers que CPUs: dá a volta (oversubscription explícita de quem pediu)
+    m_workerCpus.assign(threadCount + first, -1);
+    if(config.pinWorkers && !placement.empty())
+        for(size_t i = 0; i < threadCount; ++i)
+            m_workerCpus[first + i] = placement[i % placement.size()];
+
+    m_statsBaseline.resize(m_workerData.size() + 1);
+    m_statsBaselineNs = NowNs();
+
     for(size_t i = 0; i < threadCount; ++i)
-        m_workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this, first + i);
 }
 
 ThreadPool::~ThreadPool() {
@@ -20,49 +106,427 @@ ThreadPool::~ThreadPool() {
 
 void ThreadPool::Shutdown() {
     m_running = false;
-    for(auto& cond : m_conditions)
-        cond.notify_all();
+    m_idle.NotifyAll();
+    m_joined.NotifyAll();
 
     for(auto& t : m_workers)
         if(t.joinable())
             t.join();
+
+    // sobras de Submits que correram com o shutdown: descarta (as futures recebem broken_promise)
+    TaskSlot* task = nullptr;
+    for(auto& queue : m_injection)
+        while(queue->TryPop(task)) DiscardTask(task);
+    while(m_background->TryPop(task)) DiscardTask(task);
+    for(auto& worker : m_workerData)
+        for(auto& lane : worker->lanes)
+            while(lane.Steal(task)) DiscardTask(task);
+
+    // nada mais vai rodar: contadores já fecharam, futures descartadas ficaram prontas.
+    // Acorda quem está em Wait/WaitAndHelp/WaitUntil (os dois últimos desistem a partir daqui)
+    m_stopped.store(true, std::memory_order_seq_cst);
+    m_joined.NotifyAll();
 }
 
-void ThreadPool::WorkerLoop(size_t index) {
-    while(m_running) {
-        std::function<void()> task;
-
-        // Tenta pegar da própria fila
-        {
-            std::unique_lock<std::mutex> lock(m_mutexes[index]);
-            m_conditions[index].wait(lock, [&]{
-                return !m_queues[index].empty() || !m_running;
-            });
-
-            if(!m_running && m_queues[index].empty())
-                return;
-
-            if(!m_queues[index].empty()) {
-                task = std::move(m_queues[index].front());
-                m_queues[index].pop_front();
+void ThreadPool::DiscardTask(TaskSlot* task) {
+    m_queuedByLane[static_cast<size_t>(task->priority)].fetch_sub(1, std::memory_order_relaxed);
+    m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+
+    task->op(*task, false);
+
+    // mesmo fechamento do RunTask: quem espera no contador não pode ficar preso
+    TaskCounter* counter = task->counter;
+    FreeSlot(task);
+    if(counter && counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        m_joined.NotifyAll();
+}
+
+void ThreadPool::AttachMainThread() {
+    if(!m_mainThreadWorker)
+        throw std::logic_error("ThreadPool::MainThreadScope requires a pool built with mainThreadWorker");
+    if(t_pool != nullptr)
+        throw std::logic_error("ThreadPool::MainThreadScope: thread is already a pool worker");
+    if(m_mainAttached.exchange(true, std::memory_order_acquire))
+        throw std::logic_error("ThreadPool::MainThreadScope: worker 0 is already in use");
+
+    t_pool = this;
+    t_workerIndex = 0;
+    FrameArena::SetCurrent(&m_workerData[0]->arena);
+}
+
+void ThreadPool::DetachMainThread() {
+    // o que ficou nas lanes do worker 0 roda aqui; ninguém mais faria Pop nelas
+    helpUntil([this] { return OwnLanesEmpty(0); });
+
+    t_pool = nullptr;
+    t_workerIndex = SIZE_MAX;
+    FrameArena::SetCurrent(nullptr);
+    m_mainAttached.store(false, std::memory_order_release);
+}
+
+bool ThreadPool::OwnLanesEmpty(size_t index) const {
+    for(const auto& lane : m_workerData[index]->lanes)
+        if(!lane.Empty()) return false;
+    return true;
+}
+
+void ThreadPool::SetBackgroundWorkerLimit(size_t limit) {
+    m_backgroundLimit.store(std::max<size_t>(1, limit), std::memory_order_relaxed);
+    m_idle.NotifyAll(); // um limite maior pode liberar tarefas já enfileiradas
+}
+
+size_t ThreadPool::CurrentWorkerIndex() const {
+    return t_pool == this ? t_workerIndex : SIZE_MAX;
+}
+
+bool ThreadPool::HasIdleCapacity() const {
+    const size_t self = CurrentWorkerIndex();
+    if(self != SIZE_MAX)
+        return OwnLanesEmpty(self);
+    return m_queuedTasks.load(std::memory_order_relaxed) < static_cast<int64_t>(m_workerData.size());
+}
+
+bool ThreadPool::shutdownReached(size_t self) const {
+    // worker: o Shutdown está esperando o join dele, então para assim que o pool parar.
+    // Fora do pool: espera o Shutdown descartar as sobras (nada mais vai rodar depois disso)
+    if(self != SIZE_MAX)
+        return !m_running.load(std::memory_order_acquire);
+    return m_stopped.load(std::memory_order_acquire);
+}
+
+// ---------------------------
+// Instrumentação
+// ---------------------------
+ThreadPoolStats ThreadPool::SnapshotStats(bool reset) {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+
+    const uint64_t now = NowNs();
+    ThreadPoolStats out;
+    out.intervalMs = static_cast<double>(now - m_statsBaselineNs) * 1e-6;
+    out.workers.resize(m_workerData.size());
+
+    auto read = [&](Counters& counters, CountersBaseline& base, ThreadPoolStats::Worker* worker) {
+        CountersBaseline current;
+        current.busyNs = counters.busyNs.load(std::memory_order_relaxed);
+        current.tasksRun = counters.tasksRun.load(std::memory_order_relaxed);
+        current.stealsOk = counters.stealsOk.load(std::memory_order_relaxed);
+        current.stealsFailed = counters.stealsFailed.load(std::memory_order_relaxed);
+        for(size_t b = 0; b < ThreadPoolStats::LatencyBucketCount; ++b) {
+            current.latency[b] = counters.latency[b].load(std::memory_order_relaxed);
+            out.latency[b] += current.latency[b] - base.latency[b];
+        }
+
+        const uint64_t tasks = current.tasksRun - base.tasksRun;
+        if(worker) {
+            worker->busyMs = std::min(out.intervalMs, static_cast<double>(current.busyNs - base.busyNs) * 1e-6);
+            worker->idleMs = out.intervalMs - worker->busyMs;
+            worker->tasksRun = tasks;
+            worker->stealsOk = current.stealsOk - base.stealsOk;
+            worker->stealsFailed = current.stealsFailed - base.stealsFailed;
+            worker->maxQueueDepth = reset ? counters.maxQueueDepth.exchange(0, std::memory_order_relaxed)
+                                          : counters.maxQueueDepth.load(std::memory_order_relaxed);
+        } else {
+            out.externalTasksRun = tasks;
+        }
+
+        if(reset) base = current;
+    };
+
+    for(size_t i = 0; i < m_workerData.size(); ++i)
+        read(m_workerData[i]->stats, m_statsBaseline[i], &out.workers[i]);
+    read(m_externalStats, m_statsBaseline.back(), nullptr);
+
+    if(reset) m_statsBaselineNs = now;
+    return out;
+}
+
+// ---------------------------
+// Pools de slots
+// ---------------------------
+ThreadPool::TaskSlot* ThreadPool::AllocateChunk(uint32_t owner) {
+    auto chunk = std::make_unique<TaskSlot[]>(SlotChunkSize);
+    for(size_t i = 0; i < SlotChunkSize; ++i) {
+        chunk[i].owner = owner;
+        chunk[i].next = (i + 1 < SlotChunkSize) ? &chunk[i + 1] : nullptr;
+    }
+
+    TaskSlot* head = chunk.get();
+    m_slotChunks.push_back(std::move(chunk)); // chamado com m_chunkMutex
+    return head;
+}
+
+ThreadPool::TaskSlot* ThreadPool::AllocateSlot() {
+    const size_t self = CurrentWorkerIndex();
+    TaskSlot* slot = nullptr;
+
+    if(self != SIZE_MAX) {
+        Worker& worker = *m_workerData[self];
+        if(!worker.freeList)
+            worker.freeList = worker.remoteFree.exchange(nullptr, std::memory_order_acquire);
+        if(!worker.freeList) {
+            std::lock_guard<std::mutex> lock(m_chunkMutex);
+            worker.freeList = AllocateChunk(static_cast<uint32_t>(self));
+        }
+        slot = worker.freeList;
+        worker.freeList = slot->next;
+    } else {
+        std::lock_guard<std::mutex> lock(m_chunkMutex);
+        if(!m_externalFree)
+            m_externalFree = AllocateChunk(TaskSlot::ExternalOwner);
+        slot = m_externalFree;
+        m_externalFree = slot->next;
+    }
+
+    slot->next = nullptr;
+    slot->counter = nullptr;
+    return slot;
+}
+
+void ThreadPool::FreeSlot(TaskSlot* slot) {
+    if(slot->owner == TaskSlot::ExternalOwner) {
+        std::lock_guard<std::mutex> lock(m_chunkMutex);
+        slot->next = m_externalFree;
+        m_externalFree = slot;
+        return;
+    }
+
+    Worker& owner = *m_workerData[slot->owner];
+    if(slot->owner == CurrentWorkerIndex()) {
+        slot->next = owner.freeList;
+        owner.freeList = slot;
+        return;
+    }
+
+    // pilha de Treiber só com push; o dono esvazia com exchange, então não há ABA
+    TaskSlot* head = owner.remoteFree.load(std::memory_order_relaxed);
+    do {
+        slot->next = head;
+    } while(!owner.remoteFree.compare_exchange_weak(head, slot, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// ---------------------------
+// Filas
+// ---------------------------
+void ThreadPool::Enqueue(TaskSlot* task, TaskPriority priority) {
+    EnqueueBatch(&task, 1, priority);
+}
+
+void ThreadPool::EnqueueBatch(TaskSlot* const* tasks, size_t count, TaskPriority priority) {
+    const size_t self = CurrentWorkerIndex();
+    const size_t lane = static_cast<size_t>(priority);
+
+    const uint64_t stamp = m_instrumented.load(std::memory_order_relaxed) ? NowNs() : 0;
+    for(size_t i = 0; i < count; ++i) {
+        tasks[i]->priority = priority;
+        tasks[i]->enqueueNs = stamp;
+    }
+
+    // antes de publicar: o contador de uma lane nunca fica abaixo do que há nela
+    m_queuedByLane[lane].fetch_add(static_cast<int64_t>(count), std::memory_order_seq_cst);
+
+    if(self != SIZE_MAX && priority != TaskPriority::BACKGROUND) {
+        auto& deque = m_workerData[self]->lanes[lane];
+        for(size_t i = 0; i < count; ++i)
+            deque.Push(tasks[i]);
+
+        if(stamp) {
+            auto& maxDepth = m_workerData[self]->stats.maxQueueDepth;
+            const uint32_t depth = static_cast<uint32_t>(deque.Size());
+            if(depth > maxDepth.load(std::memory_order_relaxed))
+                maxDepth.store(depth, std::memory_order_relaxed);
+        }
+    } else {
+        // BACKGROUND sempre vai para a fila compartilhada, senão o limite de workers não vale
+        auto& queue = (priority == TaskPriority::BACKGROUND) ? *m_background : *m_injection[lane];
+        for(size_t i = 0; i < count; ++i) {
+            while(!queue.TryPush(tasks[i])) {
+                // fila cheia: ajuda a esvaziar as filas de frame em vez de bloquear
+                TaskSlot* other = nullptr;
+                if(m_injection[0]->TryPop(other) || m_injection[1]->TryPop(other) || m_injection[2]->TryPop(other))
+                    RunTask(other);
+                else
+                    std::this_thread::yield();
             }
         }
+    }
+
+    m_queuedTasks.fetch_add(static_cast<int64_t>(count), std::memory_order_seq_cst);
+    Signal(count);
+}
+
+void ThreadPool::Signal(size_t count) {
+    const uint32_t n = static_cast<uint32_t>(std::min<size_t>(count, UINT32_MAX));
+    m_idle.Notify(n);
+    m_joined.Notify(n);
+}
+
+void ThreadPool::RunTask(TaskSlot* task) {
+    const bool background = task->priority == TaskPriority::BACKGROUND;
+    m_queuedByLane[static_cast<size_t>(task->priority)].fetch_sub(1, std::memory_order_relaxed);
+    m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+
+    const size_t self = CurrentWorkerIndex();
+    Counters* stats = m_instrumented.load(std::memory_order_relaxed) ? &StatsFor(self) : nullptr;
+    const bool shared = self == SIZE_MAX;
+    uint64_t start = 0;
+    if(stats) {
+        start = NowNs();
+        if(task->enqueueNs && start > task->enqueueNs)
+            AddCounter(stats->latency[LatencyBucket(start - task->enqueueNs)], 1, shared);
+        AddCounter(stats->tasksRun, 1, shared);
+    }
+
+    ++t_runDepth;
+    try {
+        task->op(*task, true);
+    } catch(const std::exception& e) {
+        CP_LOG_ERROR("[ThreadPool] unhandled exception in task: {}", e.what());
+    } catch(...) {
+        CP_LOG_ERROR("[ThreadPool] unhandled exception in task");
+    }
+    --t_runDepth;
+
+    // tarefas aninhadas (Wait dentro de tarefa) já estão no tempo da externa
+    if(stats && t_runDepth == 0)
+        AddCounter(stats->busyNs, NowNs() - start, shared);
+
+    TaskCounter* counter = task->counter;
+    FreeSlot(task);
+
+    // vaga reservada em FindBackground
+    if(background)
+        m_backgroundActive.fetch_sub(1, std::memory_order_release);
+
+    // o fetch_sub é o último acesso ao contador: quem espera pode destruí-lo em seguida
+    if(counter && counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        m_joined.NotifyAll();
+}
+
+ThreadPool::TaskSlot* ThreadPool::FindInLane(size_t index, size_t lane) {
+    // contador seq_cst: pareado com PrepareWait, não esconde uma tarefa de quem vai estacionar
+    if(m_queuedByLane[lane].load(std::memory_order_seq_cst) <= 0)
+        return nullptr;
+
+    TaskSlot* task = nullptr;
+    const bool isWorker = index != SIZE_MAX;
+
+    // própria lane primeiro (localidade), depois a injeção, depois roubo na MESMA prioridade
+    if(isWorker && m_workerData[index]->lanes[lane].Pop(task)) return task;
+    if(m_injection[lane]->TryPop(task)) return task;
+
+    const size_t count = m_workerData.size();
+    const size_t start = static_cast<size_t>(NextRandom() % count);
+    for(size_t i = 0; i < count; ++i) {
+        size_t victim = (start + i) % count;
+        if(victim == index) continue;
+        const bool stolen = m_workerData[victim]->lanes[lane].Steal(task);
+        if(m_instrumented.load(std::memory_order_relaxed)) {
+            Counters& stats = StatsFor(index);
+            AddCounter(stolen ? stats.stealsOk : stats.stealsFailed, 1, !isWorker);
+        }
+        if(stolen) return task;
+    }
+    return nullptr;
+}
+
+ThreadPool::TaskSlot* ThreadPool::FindBackground() {
+    if(m_queuedByLane[static_cast<size_t>(TaskPriority::BACKGROUND)].load(std::memory_order_seq_cst) <= 0)
+        return nullptr;
+
+    // reserva uma vaga antes de tirar da fila; RunTask devolve
+    size_t active = m_backgroundActive.load(std::memory_order_relaxed);
+    do {
+        if(active >= m_backgroundLimit.load(std::memory_order_relaxed))
+            return nullptr;
+    } while(!m_backgroundActive.compare_exchange_weak(active, active + 1, std::memory_order_acquire, std::memory_order_relaxed));
+
+    TaskSlot* task = nullptr;
+    if(m_background->TryPop(task))
+        return task;
+
+    m_backgroundActive.fetch_sub(1, std::memory_order_release);
+    return nullptr;
+}
+
+ThreadPool::TaskSlot* ThreadPool::FindTask(size_t index, bool allowBackground) {
+    constexpr size_t High = static_cast<size_t>(TaskPriority::HIGH);
+    constexpr size_t Normal = static_cast<size_t>(TaskPriority::NORMAL);
+    constexpr size_t Low = static_cast<size_t>(TaskPriority::LOW);
+
+    TaskSlot* task = nullptr;
+
+    // aging: de tempos em tempos LOW passa na frente
+    if(index != SIZE_MAX && ++m_workerData[index]->lookups % LowAgingInterval == 0)
+        if((task = FindInLane(index, Low))) return task;
+
+    if((task = FindInLane(index, High))) return task;
+    if((task = FindInLane(index, Normal))) return task;
+    if((task = FindInLane(index, Low))) return task;
+
+    // BACKGROUND só quando não há trabalho de frame visível
+    if(allowBackground && (task = FindBackground())) return task;
+    return nullptr;
+}
+
+void ThreadPool::Wait(TaskCounter& counter) {
+    // contadores sempre fecham (RunTask ou DiscardTask no Shutdown): nunca desiste
+    helpUntil([&counter] { return counter.m_pending.load(std::memory_order_acquire) <= 0; }, false);
+}
+
+void ThreadPool::WorkerLoop(size_t index) {
+    t_pool = this;
+    t_workerIndex = index;
+    t_rngState = 0x9E3779B97F4A7C15ull * (index + 1);
+    FrameArena::SetCurrent(&m_workerData[index]->arena);
+
+    if(!m_threadNamePrefix.empty())
+        SetCurrentThreadName(m_threadNamePrefix + "-" + std::to_string(index));
+    if(m_workerCpus[index] >= 0) {
+        const uint32_t cpu = static_cast<uint32_t>(m_workerCpus[index]);
+        SetCurrentThreadAffinity(std::span<const uint32_t>(&cpu, 1));
+    }
+
+    for(;;) {
+        TaskSlot* task = FindTask(index, true);
+
+        // 1) spin curto: trabalho costuma chegar logo depois de acabar (tarefas pequenas por frame)
+        for(int spin = 0; !task && spin < SpinRounds; ++spin) {
+            for(int i = 0; i < 16; ++i) CpuRelax();
+            task = FindTask(index, true);
+        }
 
-        // Work-stealing
         if(!task) {
-            for(size_t i = 0; i < m_queues.size(); ++i) {
-                if(i == index) continue;
-                std::lock_guard<std::mutex> lock(m_mutexes[i]);
-                if(!m_queues[i].empty()) {
-                    task = std::move(m_queues[i].back());
-                    m_queues[i].pop_back();
+            // só encerra depois de drenar as filas
+            if(!m_running.load(std::memory_order_acquire))
+                break;
+
+            // 2) estaciona; re-checa depois de se registrar para não perder um Submit concorrente
+            EventCount::Key key = m_idle.PrepareWait();
+            task = FindTask(index, true);
+            if(!task) {
+                if(!m_running.load(std::memory_order_acquire)) {
+                    m_idle.CancelWait();
                     break;
                 }
+                m_idle.CommitWait(key);
+                continue;
             }
+            m_idle.CancelWait();
         }
 
-        if(task) task();
+        // ainda há fila: acorda mais um (cresce em proporção ao backlog). BACKGROUND acima do
+        // limite não conta, senão workers acordariam só para voltar a dormir
+        const int64_t background = m_queuedByLane[static_cast<size_t>(TaskPriority::BACKGROUND)].load(std::memory_order_relaxed);
+        const bool backgroundSlot = background > 0 && m_backgroundActive.load(std::memory_order_relaxed) < m_backgroundLimit.load(std::memory_order_relaxed);
+        if(m_queuedTasks.load(std::memory_order_relaxed) - (backgroundSlot ? 0 : background) > 1)
+            m_idle.Notify(1);
+
+        RunTask(task);
     }
+
+    FrameArena::SetCurrent(nullptr);
+    t_pool = nullptr;
+    t_workerIndex = SIZE_MAX;
 }
 
 } // namespace cp_api
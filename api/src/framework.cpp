@@ -7,6 +7,8 @@
 #include "cp_api/world/world.hpp"
 
 #include "cp_api/core/threadPool.hpp"
+#include "cp_api/core/task.hpp"
+#include "cp_api/core/threadAffinity.hpp"
 
 #include "cp_api/components/uiComponent.hpp"
 #include "cp_api/components/cameraComponent.hpp"
@@ -26,9 +28,22 @@ namespace cp_api {
     }
 
     void Framework::Init() {
-        m_threadPool = std::make_unique<ThreadPool>();
+        // núcleos reservados para a main e a render thread; workers fixos no resto (sem migração
+        // nem competição com elas). A main ainda entra como worker 0 durante o frame.
+        ThreadPoolConfig poolConfig;
+        poolConfig.mainThreadWorker = true;
+        poolConfig.reservedCores = CpuTopology::Get().GetPhysicalCount() > 4 ? 2 : 1;
+        poolConfig.pinWorkers = true;
+        m_threadPool = std::make_unique<ThreadPool>(poolConfig);
+
+        SetCurrentThreadName("cp-main");
+        SetCurrentThreadAffinity(m_threadPool->GetReservedCpus());
+        m_frameScheduler = std::make_unique<FrameScheduler>(*m_threadPool);
+#ifndef NDEBUG
+        m_threadPool->SetInstrumentation(true);
+#endif
         m_diagnostics = std::make_unique<DiagnosticsManager>();
-        m_world = std::make_unique<World>();
+        m_world = std::make_unique<World>(m_threadPool.get());
         m_window = std::make_unique<Window>(800, 600, "CP_API Window", *m_world, *m_threadPool);
 
         CP_LOG_INFO("Framework initialized.");
@@ -58,7 +73,7 @@ namespace cp_api {
         auto e = reg.create();
         UICanvas& canvas = reg.emplace<UICanvas>(e);
         canvas.name = "Diagnostics";
-        canvas.size = ImVec2(450, 150);
+        canvas.size = ImVec2(450, 300);
         auto& t = canvas.AddChild<UIText>();
         t.text = "";
 
@@ -74,11 +89,17 @@ namespace cp_api {
         //-----------------------------------------------------------------------------------
 
         while(!m_window->ShouldClose() && m_isRunning) {
+            // fases do frame: Wait/WaitAndHelp aqui executam tarefas em vez de bloquear
+            ThreadPool::MainThreadScope frameScope(*m_threadPool);
+            m_frameScheduler->AdvanceFrame();
+
             m_diagnostics->BeginFrame();
 
             m_diagnostics->StartTimer("WindowUpdate");
             {
                 m_window->Update();
+                // eventos enfileirados desde o último frame (de qualquer thread) saem aqui, em lote
+                m_window->GetEventDispatcher().FlushQueued();
             }
             m_diagnostics->StopTimer("WindowUpdate");
             
@@ -138,6 +159,13 @@ namespace cp_api {
             }
             m_diagnostics->StopTimer("WorldUpdate");
 
+            m_diagnostics->StartTimer("SyncTransforms");
+            {
+                // transforms alterados no frame -> bounds + SpatialTree, em lote, antes do culling
+                m_world->SyncTransforms();
+            }
+            m_diagnostics->StopTimer("SyncTransforms");
+
             m_diagnostics->StartTimer("WindowWorldProcess");
             {
                 m_window->Render();
@@ -145,6 +173,11 @@ namespace cp_api {
             
             m_diagnostics->EndFrame();
 
+            // tudo do frame já foi esperado: memória temporária dos workers volta ao início
+            m_threadPool->ResetFrameArenas();
+            if(m_threadPool->IsInstrumentationEnabled())
+                m_diagnostics->ReportThreadPool(m_threadPool->SnapshotStats(true));
+
 #ifndef NDEBUG
             timerUpdate += dt;
             if(timerUpdate >= 1.0) {
@@ -4,6 +4,8 @@
 #include "cp_api/graphics/renderTargetManager.hpp"
 
 #include "cp_api/core/threadPool.hpp"
+#include "cp_api/core/threadAffinity.hpp"
+#include "cp_api/core/frameArena.hpp"
 #include "cp_api/core/debug.hpp"
 
 #include "cp_api/world/world.hpp"
@@ -33,7 +35,12 @@ namespace cp_api {
         m_rtManager->Init(&m_vulkan);
         createMainCamera();
 
-        m_renderThreadWorker = std::thread([this]() { submitThreadWork(); });
+        m_renderThreadWorker = std::thread([this]() {
+            // divide os núcleos reservados com a main thread, longe dos workers do pool
+            SetCurrentThreadName("cp-render");
+            SetCurrentThreadAffinity(m_threadPool.GetReservedCpus());
+            submitThreadWork();
+        });
         CP_LOG_SUCCESS("Successfully created renderer object!");
     }
 
@@ -84,9 +91,9 @@ namespace cp_api {
             // --------------------
             // 1) CULLING 
             // --------------------
-            Mat4 vp = cc.GetProjectionMatrix() * cc.GetViewMatrix(tc.position, tc.rotation, tc.scale);
+            Mat4 vp = cc.GetProjectionMatrix() * cc.GetViewMatrix(tc.GetPosition(), tc.GetRotation(), tc.GetScale());
             shapes3D::Frustum frustum = shapes3D::Frustum::FromMatrix(vp);
-            std::vector<physics3D::HitInfo> hits;
+            std::pmr::vector<physics3D::HitInfo> hits(FrameArena::CurrentResource());
             world.QueryFrustum(frustum, hits, cc.viewMask);
 
             //if hit anything, continue
@@ -157,7 +164,8 @@ namespace cp_api {
                 push.objectID = orc->objectID;
 
                 auto& hitInfo = hits[i];
-                CP_LOG_WARN("cam x {} y {} z {} - drawing object id {} distance: {}", tc.position.x, tc.position.y, tc.position.z, orc->objectID, hitInfo.distance);
+                const Vec3 camPos = tc.GetPosition();
+                CP_LOG_WARN("cam x {} y {} z {} - drawing object id {} distance: {}", camPos.x, camPos.y, camPos.z, orc->objectID, hitInfo.distance);
             }
 
             vkEndCommandBuffer(cb);
@@ -240,7 +248,7 @@ namespace cp_api {
 
         // Espera todos workers completarem gravação
         // for (auto &wf : workerFutures) {
-        //     VkResult rr = wf.fut.get();
+        //     VkResult rr = m_threadPool.WaitAndHelp(wf.fut);
         //     if (rr != VK_SUCCESS) {
         //         CP_LOG_THROW("Worker failed to record secondary CB");
         //     }
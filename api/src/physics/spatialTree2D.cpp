@@ -2,18 +2,23 @@
 
 #include <algorithm>
 #include <unordered_set>
+#include <memory_resource>
 #include <cmath>
 
+#include "cp_api/core/frameArena.hpp"
+
 void SpatialTree2D::QueryCircle(const cp_api::shapes2D::Circle& circle, std::vector<uint32_t>& outIds, uint32_t queryMask) const {
     cp_api::physics2D::AABB range(
         circle.center - Vec2(circle.radius),
         circle.center + Vec2(circle.radius)
     );
 
-    std::vector<uint32_t> candidateIds;
+    cp_api::FrameArena::Scope scratch;
+
+    std::pmr::vector<uint32_t> candidateIds(scratch.Resource());
     this->QueryRange(range, candidateIds, queryMask);
 
-    std::unordered_set<uint32_t> uniqueIds;
+    std::pmr::unordered_set<uint32_t> uniqueIds(scratch.Resource());
     for (uint32_t id : candidateIds) {
         const auto entry = this->FindEntry(id);
         if (!entry.has_value()) continue;
@@ -37,7 +42,9 @@ void SpatialTree2D::QueryCircle(const cp_api::shapes2D::Circle& circle, std::vec
         circle.center + Vec2(circle.radius)
     );
 
-    std::vector<uint32_t> candidateIds;
+    cp_api::FrameArena::Scope scratch;
+
+    std::pmr::vector<uint32_t> candidateIds(scratch.Resource());
     this->QueryRange(range, candidateIds, queryMask);
 
     for (uint32_t id : candidateIds) {
@@ -86,10 +93,12 @@ void SpatialTree2D::QueryCircle(const cp_api::shapes2D::Circle& circle, std::vec
 void SpatialTree2D::QueryCapsule(const cp_api::shapes2D::Capsule& capsule, std::vector<uint32_t>& outIds, uint32_t queryMask) const {
     cp_api::physics2D::AABB range = capsule.GetAABB();
 
-    std::vector<uint32_t> candidates;
+    cp_api::FrameArena::Scope scratch;
+
+    std::pmr::vector<uint32_t> candidates(scratch.Resource());
     this->QueryRange(range, candidates, queryMask);
 
-    std::unordered_set<uint32_t> uniqueIds;
+    std::pmr::unordered_set<uint32_t> uniqueIds(scratch.Resource());
     for (uint32_t id : candidates) {
         auto entry = FindEntry(id);
         if (!entry.has_value()) continue;
@@ -114,7 +123,8 @@ void SpatialTree2D::QueryCapsule(const cp_api::shapes2D::Capsule& capsule, std::
     );
 
     cp_api::physics2D::AABB capsuleAABB(minBound, maxBound);
-    std::vector<uint32_t> candidateIds;
+    cp_api::FrameArena::Scope scratch;
+    std::pmr::vector<uint32_t> candidateIds(scratch.Resource());
     this->QueryRange(capsuleAABB, candidateIds, queryMask);
 
     const auto& p1 = capsule.p0;
@@ -173,7 +183,9 @@ void SpatialTree2D::QueryBox(const cp_api::physics2D::AABB& range, std::vector<c
 
     outInfos.clear();
 
-    std::vector<uint32_t> ids;
+    cp_api::FrameArena::Scope scratch;
+
+    std::pmr::vector<uint32_t> ids(scratch.Resource());
     this->QueryRange(range, ids, queryMask);
 
     for (uint32_t id : ids) {
@@ -217,7 +229,9 @@ void SpatialTree2D::QueryBox(const cp_api::physics2D::AABB& range, std::vector<c
 void SpatialTree2D::QueryRay(const cp_api::physics2D::Ray& ray, std::vector<cp_api::physics2D::HitInfo>& outInfos, float maxDist, uint32_t queryMask) const {
     outInfos.clear();
 
-    std::vector<uint32_t> ids;
+    cp_api::FrameArena::Scope scratch;
+
+    std::pmr::vector<uint32_t> ids(scratch.Resource());
     cp_api::physics2D::AABB rayBox(
         ray.origin - Vec2(maxDist),
         ray.origin + Vec2(maxDist)
@@ -2,8 +2,10 @@
 
 #include <algorithm>
 #include <unordered_set>
+#include <memory_resource>
 #include <cmath>
 #include "cp_api/core/math.hpp"
+#include "cp_api/core/frameArena.hpp"
 
 void SpatialTree3D::QuerySphere(const cp_api::shapes3D::Sphere& sphere, std::vector<uint32_t>& outIds, uint32_t queryMask) const {
     cp_api::physics3D::AABB range(
@@ -11,10 +13,12 @@ void SpatialTree3D::QuerySphere(const cp_api::shapes3D::Sphere& sphere, std::vec
         sphere.center + Vec3(sphere.radius, sphere.radius, sphere.radius)
     );
 
-    std::vector<uint32_t> candidateIds;
+    cp_api::FrameArena::Scope scratch;
+
+    std::pmr::vector<uint32_t> candidateIds(scratch.Resource());
     this->QueryRange(range, candidateIds, queryMask);
 
-    std::unordered_set<uint32_t> uniqueIds;
+    std::pmr::unordered_set<uint32_t> uniqueIds(scratch.Resource());
 
     for (uint32_t id : candidateIds) {
         const auto entry = this->FindEntry(id);
@@ -43,10 +47,11 @@ void SpatialTree3D::QuerySphere(const cp_api::shapes3D::Sphere& sphere, std::vec
     );
 
     // candidatos
-    std::vector<uint32_t> candidateIds;
+    cp_api::FrameArena::Scope scratch;
+    std::pmr::vector<uint32_t> candidateIds(scratch.Resource());
     this->QueryRange(range, candidateIds, queryMask);
 
-    std::unordered_set<uint32_t> seen;
+    std::pmr::unordered_set<uint32_t> seen(scratch.Resource());
     for (uint32_t id : candidateIds) {
         if (!seen.insert(id).second) continue; // já processado
 
@@ -93,10 +98,12 @@ void SpatialTree3D::QuerySphere(const cp_api::shapes3D::Sphere& sphere, std::vec
 void SpatialTree3D::QueryCapsule(const cp_api::shapes3D::Capsule& capsule, std::vector<uint32_t>& outIds, uint32_t queryMask) const {
     cp_api::physics3D::AABB range = capsule.GetAABB();
 
-    std::vector<uint32_t> candidates;
+    cp_api::FrameArena::Scope scratch;
+
+    std::pmr::vector<uint32_t> candidates(scratch.Resource());
     this->QueryRange(range, candidates, queryMask);
 
-    std::unordered_set<uint32_t> uniqueIds;
+    std::pmr::unordered_set<uint32_t> uniqueIds(scratch.Resource());
     for (uint32_t id : candidates) {
         auto entry = FindEntry(id);
         if (!entry.has_value()) continue;
@@ -116,7 +123,8 @@ void SpatialTree3D::QueryCapsule(const cp_api::shapes3D::Capsule& capsule, std::
 
     // Broadphase AABB da cápsula
     cp_api::physics3D::AABB range = capsule.GetAABB();
-    std::vector<uint32_t> candidateIds;
+    cp_api::FrameArena::Scope scratch;
+    std::pmr::vector<uint32_t> candidateIds(scratch.Resource());
     this->QueryRange(range, candidateIds, queryMask);
 
     const Vec3 p0 = capsule.p0;
@@ -125,7 +133,7 @@ void SpatialTree3D::QueryCapsule(const cp_api::shapes3D::Capsule& capsule, std::
     const float segLen = glm::length(seg);
     Vec3 segDir = (segLen > 1e-8f) ? (seg / segLen) : Vec3(0.0f);
 
-    std::unordered_set<uint32_t> seen;
+    std::pmr::unordered_set<uint32_t> seen(scratch.Resource());
     for (uint32_t id : candidateIds) {
         if (!seen.insert(id).second) continue;
 
@@ -200,7 +208,9 @@ void SpatialTree3D::QueryCube(const cp_api::physics3D::AABB& range, std::vector<
 
     outInfos.clear();
 
-    std::vector<uint32_t> ids;
+    cp_api::FrameArena::Scope scratch;
+
+    std::pmr::vector<uint32_t> ids(scratch.Resource());
     this->QueryRange(range, ids, queryMask);
 
     for (uint32_t id : ids)
@@ -258,7 +268,9 @@ void SpatialTree3D::QueryCube(const cp_api::physics3D::AABB& range, std::vector<
 void SpatialTree3D::QueryRay(const cp_api::physics3D::Ray& ray, std::vector<cp_api::physics3D::HitInfo>& outInfos, float maxDist, uint32_t queryMask) const {
     outInfos.clear();
 
-    std::vector<uint32_t> ids;
+    cp_api::FrameArena::Scope scratch;
+
+    std::pmr::vector<uint32_t> ids(scratch.Resource());
     cp_api::physics3D::AABB rayBox(
         ray.origin - Vec3(maxDist, maxDist, maxDist),
         ray.origin + Vec3(maxDist, maxDist, maxDist)
@@ -295,7 +307,20 @@ void SpatialTree3D::QueryFrustum(const cp_api::shapes3D::Frustum& frustum,
 
 void SpatialTree3D::QueryFrustum(const cp_api::shapes3D::Frustum& frustum,
                                  std::vector<cp_api::physics3D::HitInfo>& outInfos,
-                                 uint32_t queryMask) const
+                                 uint32_t queryMask) const {
+    queryFrustumInfos(frustum, outInfos, queryMask);
+}
+
+void SpatialTree3D::QueryFrustum(const cp_api::shapes3D::Frustum& frustum,
+                                 std::pmr::vector<cp_api::physics3D::HitInfo>& outInfos,
+                                 uint32_t queryMask) const {
+    queryFrustumInfos(frustum, outInfos, queryMask);
+}
+
+template<typename OutInfos>
+void SpatialTree3D::queryFrustumInfos(const cp_api::shapes3D::Frustum& frustum,
+                                      OutInfos& outInfos,
+                                      uint32_t queryMask) const
 {
     using namespace cp_api::physics3D;
     using namespace cp_api::math;
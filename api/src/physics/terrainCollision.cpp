@@ -0,0 +1,551 @@
+#include "cp_api/physics/terrainCollision.hpp"
+#include "cp_api/core/debug.hpp"
+#include "cp_api/core/threadPool.hpp"
+#include "cp_api/core/frameArena.hpp"
+
+namespace cp_api::physics {
+
+    // ------------------------------------------------------------
+    // Kernels SoA (variante por ISA escolhida em GetTriangleKernels)
+    // ------------------------------------------------------------
+    bool RayIntersectsTriangleBlock(const Vec3& orig, const Vec3& dir, const TriangleBlock8& block, float& bestT, int& outLane)
+    {
+        const float o[3] = { orig.x, orig.y, orig.z };
+        const float d[3] = { dir.x, dir.y, dir.z };
+        return GetTriangleKernels().rayBlock(o, d, block, bestT, outLane);
+    }
+
+    int SphereIntersectsTriangleBlock(const shapes3D::Sphere& s, const TriangleBlock8& block, Vec3& correction)
+    {
+        const float center[3] = { s.center.x, s.center.y, s.center.z };
+        SphereBlockContacts contacts;
+        const int bits = GetTriangleKernels().sphereBlock(center, s.radius, block, contacts);
+
+        int hits = 0;
+        for (int lane = 0; lane < simd::Width; ++lane) {
+            if (!(bits & (1 << lane))) continue;
+
+            const float dist = contacts.dist[lane];
+            Vec3 normal;
+            if (dist > 1e-6f) {
+                normal = Vec3(contacts.nx[lane], contacts.ny[lane], contacts.nz[lane]);
+            } else {
+                // centro sobre o triângulo: usa a normal da face
+                Vec3 e1(block.e1x[lane], block.e1y[lane], block.e1z[lane]);
+                Vec3 e2(block.e2x[lane], block.e2y[lane], block.e2z[lane]);
+                normal = math::Normalize(math::Cross(e1, e2));
+            }
+            correction += normal * (s.radius - dist);
+            ++hits;
+        }
+        return hits;
+    }
+
+    // ------------------------------------------------------------
+    // TerrainCollider
+    // ------------------------------------------------------------
+    void TerrainCollider::AddTriangle(const Vec3& v0, const Vec3& v1, const Vec3& v2) {
+        uint32_t id = static_cast<uint32_t>(GetTriangleCount());
+        m_pending.push_back(v0);
+        m_pending.push_back(v1 - v0);
+        m_pending.push_back(v2 - v0);
+
+        Vec3 bmin = glm::min(glm::min(v0, v1), v2);
+        Vec3 bmax = glm::max(glm::max(v0, v1), v2);
+        AABB3 aabb{ bmin, bmax };
+
+        m_tree.Insert(id, aabb, nullptr);
+        m_blocksDirty = true;
+    }
+
+    void TerrainCollider::AddMesh(std::span<const Vec3> vertices, std::span<const uint32_t> indices) {
+        if (indices.size() % 3 != 0)
+            CP_LOG_THROW("[TerrainCollider] AddMesh: index count {} is not a multiple of 3", indices.size());
+
+        const size_t pendingBase = m_pending.size();
+        const uint32_t firstTri = static_cast<uint32_t>(GetTriangleCount());
+        const size_t triCount = indices.size() / 3;
+
+        m_pending.reserve(pendingBase + triCount * 3);
+
+        std::vector<Tree::Entry> entries;
+        entries.reserve(triCount);
+
+        // passo linear único: valida os índices, guarda v0/arestas e calcula os AABBs
+        for (size_t t = 0; t < triCount; ++t) {
+            const uint32_t i0 = indices[t * 3 + 0];
+            const uint32_t i1 = indices[t * 3 + 1];
+            const uint32_t i2 = indices[t * 3 + 2];
+            if (i0 >= vertices.size() || i1 >= vertices.size() || i2 >= vertices.size()) {
+                m_pending.resize(pendingBase);
+                CP_LOG_THROW("[TerrainCollider] AddMesh: triangle {} references a vertex out of range", t);
+            }
+
+            const Vec3& v0 = vertices[i0];
+            const Vec3& v1 = vertices[i1];
+            const Vec3& v2 = vertices[i2];
+            m_pending.push_back(v0);
+            m_pending.push_back(v1 - v0);
+            m_pending.push_back(v2 - v0);
+
+            AABB3 aabb{ glm::min(glm::min(v0, v1), v2), glm::max(glm::max(v0, v1), v2) };
+            entries.push_back({ firstTri + static_cast<uint32_t>(t), aabb, 0xFFFFFFFF, nullptr });
+        }
+
+        if (m_tree.GetItemCount() == 0) {
+            m_tree.BulkLoad(std::move(entries));
+        } else {
+            for (const auto& e : entries)
+                m_tree.Insert(e.id, e.bounds, nullptr);
+        }
+
+        m_blocksDirty = true;
+    }
+
+    void TerrainCollider::triangleEdges(uint32_t id, Vec3& v0, Vec3& e1, Vec3& e2) const {
+        if (id < m_triangleSlots.size()) {
+            const uint32_t slot = m_triangleSlots[id];
+            const TriangleBlock8& block = m_blocks[slot / simd::Width];
+            const uint32_t lane = slot % simd::Width;
+            v0 = Vec3(block.v0x[lane], block.v0y[lane], block.v0z[lane]);
+            e1 = Vec3(block.e1x[lane], block.e1y[lane], block.e1z[lane]);
+            e2 = Vec3(block.e2x[lane], block.e2y[lane], block.e2z[lane]);
+            return;
+        }
+
+        const size_t p = (id - m_triangleSlots.size()) * 3;
+        v0 = m_pending[p];
+        e1 = m_pending[p + 1];
+        e2 = m_pending[p + 2];
+    }
+
+    shapes::Triangle TerrainCollider::GetTriangle(uint32_t id) const {
+        Vec3 v0, e1, e2;
+        triangleEdges(id, v0, e1, e2);
+        return shapes::Triangle{ v0, v0 + e1, v0 + e2, math::Normalize(math::Cross(e1, e2)) };
+    }
+
+    Vec3 TerrainCollider::GetTriangleNormal(uint32_t id) const {
+        Vec3 v0, e1, e2;
+        triangleEdges(id, v0, e1, e2);
+        return math::Normalize(math::Cross(e1, e2));
+    }
+
+    size_t TerrainCollider::GetMemoryUsage() const {
+        size_t bytes = sizeof(TerrainCollider);
+        bytes += m_blocks.capacity() * sizeof(TriangleBlock8);
+        bytes += m_nodeBlocks.capacity() * sizeof(BlockRange);
+        bytes += m_triangleSlots.capacity() * sizeof(uint32_t);
+        bytes += m_pending.capacity() * sizeof(Vec3);
+        // árvore: uma entrada por triângulo + os nós folha conhecidos pelos blocos
+        bytes += GetTriangleCount() * sizeof(Tree::Entry);
+        bytes += m_nodeBlocks.size() * sizeof(Tree::Node);
+        return bytes;
+    }
+
+    void TerrainCollider::Build() {
+        // os blocos antigos ainda são a fonte dos triângulos já construídos
+        std::vector<TriangleBlock8> blocks;
+        std::vector<uint32_t> slots(GetTriangleCount(), UINT32_MAX);
+        blocks.reserve(m_blocks.size() + (m_pending.size() / 3 + simd::Width - 1) / simd::Width);
+        m_nodeBlocks.clear();
+
+        std::vector<Tree::Node*> nodes;
+        m_tree.GetItemNodes(nodes);
+        m_nodeBlocks.reserve(nodes.size());
+
+        for (Tree::Node* node : nodes) {
+            BlockRange range;
+            range.first = static_cast<uint32_t>(blocks.size());
+
+            const size_t itemCount = node->items.size();
+            for (size_t i = 0; i < itemCount; i += simd::Width) {
+                const uint32_t blockIndex = static_cast<uint32_t>(blocks.size());
+                TriangleBlock8& block = blocks.emplace_back();
+                const size_t n = std::min<size_t>(simd::Width, itemCount - i);
+                for (size_t lane = 0; lane < simd::Width; ++lane) {
+                    if (lane >= n) {
+                        block.v0x[lane] = block.v0y[lane] = block.v0z[lane] = 0.0f;
+                        block.e1x[lane] = block.e1y[lane] = block.e1z[lane] = 0.0f;
+                        block.e2x[lane] = block.e2y[lane] = block.e2z[lane] = 0.0f;
+                        block.ids[lane] = UINT32_MAX;
+                        continue;
+                    }
+
+                    const uint32_t id = node->items[i + lane].id;
+                    Vec3 v0, e1, e2;
+                    triangleEdges(id, v0, e1, e2);
+                    block.v0x[lane] = v0.x;     block.v0y[lane] = v0.y;     block.v0z[lane] = v0.z;
+                    block.e1x[lane] = e1.x;     block.e1y[lane] = e1.y;     block.e1z[lane] = e1.z;
+                    block.e2x[lane] = e2.x;     block.e2y[lane] = e2.y;     block.e2z[lane] = e2.z;
+                    block.ids[lane] = id;
+                    slots[id] = blockIndex * simd::Width + static_cast<uint32_t>(lane);
+                }
+                block.count = static_cast<uint32_t>(n);
+                ++range.count;
+            }
+
+            // faixa guardada no próprio nó: as consultas não passam por hash
+            node->userIndex = static_cast<uint32_t>(m_nodeBlocks.size());
+            m_nodeBlocks.push_back(range);
+        }
+
+        m_blocks.swap(blocks);
+        m_triangleSlots.swap(slots);
+        m_pending.clear();
+        m_pending.shrink_to_fit();
+        m_blocksDirty = false;
+    }
+
+    void TerrainCollider::requireBuilt() const
+    {
+        if (m_blocksDirty)
+            CP_LOG_THROW("[TerrainCollider] query before Build() ({} pending triangles)", m_pending.size() / 3);
+    }
+
+    bool TerrainCollider::CollideSphere(shapes3D::Sphere& s, Vec3& correctionOut)
+    {
+        requireBuilt();
+
+        FrameArena::Scope arena;
+        QueryScratch scratch(arena.Resource());
+        bool collided = collideSphere(s, correctionOut, scratch);
+        if (collided)
+            s.center += correctionOut;
+
+        return collided;
+    }
+
+    bool TerrainCollider::CollideCapsule(shapes3D::Capsule& c, Vec3& correctionOut)
+    {
+        requireBuilt();
+
+        FrameArena::Scope arena;
+        QueryScratch scratch(arena.Resource());
+        bool collided = collideCapsule(c, correctionOut, scratch);
+        if (collided) {
+            c.p0 += correctionOut;
+            c.p1 += correctionOut;
+        }
+
+        return collided;
+    }
+
+    template<typename Shape, typename CenterFn, typename CollideFn>
+    size_t TerrainCollider::collideBatch(ThreadPool& pool, std::span<const Shape> shapes, std::span<Vec3> correctionsOut,
+                                         CenterFn&& center, CollideFn&& collide)
+    {
+        if (correctionsOut.size() < shapes.size())
+            CP_LOG_THROW("[TerrainCollider] batch output has {} slots for {} queries", correctionsOut.size(), shapes.size());
+
+        const size_t count = shapes.size();
+        if (count == 0)
+            return 0;
+
+        requireBuilt();
+
+        // ordem de Morton: (código << 32) | índice original; local, lotes podem se sobrepor
+        FrameArena::Scope arena;
+        std::pmr::vector<uint64_t> order(count, arena.Resource());
+        for (size_t i = 0; i < count; ++i)
+            order[i] = (static_cast<uint64_t>(mortonCode(center(shapes[i]))) << 32) | static_cast<uint64_t>(i);
+        std::sort(order.begin(), order.end());
+
+        // um pedaço contíguo por worker (+1 para a thread chamadora)
+        constexpr size_t MinQueriesPerChunk = 64;
+        const size_t maxChunks = pool.GetWorkerCount() + 1;
+        const size_t chunkCount = std::clamp<size_t>((count + MinQueriesPerChunk - 1) / MinQueriesPerChunk, 1, maxChunks);
+        const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+        std::atomic<size_t> collided{ 0 };
+        auto runChunk = [&](size_t chunk) {
+            // scratch no arena de quem roda o pedaço
+            FrameArena::Scope chunkArena;
+            QueryScratch scratch(chunkArena.Resource());
+            const size_t begin = chunk * chunkSize;
+            const size_t end = std::min(count, begin + chunkSize);
+            size_t local = 0;
+            for (size_t k = begin; k < end; ++k) {
+                const uint32_t i = static_cast<uint32_t>(order[k]);
+                if (collide(shapes[i], correctionsOut[i], scratch))
+                    ++local;
+            }
+            collided.fetch_add(local, std::memory_order_relaxed);
+        };
+
+        // Dispatch + TaskCounter: nada vai para o heap por tick (slots reciclados do pool)
+        TaskCounter counter;
+        for (size_t chunk = 1; chunk < chunkCount; ++chunk)
+            pool.Dispatch(TaskPriority::HIGH, counter, [&runChunk, chunk] { runChunk(chunk); });
+
+        runChunk(0);
+
+        // ajuda em vez de bloquear: collideBatch pode ser chamado de dentro de um job
+        pool.Wait(counter);
+
+        return collided.load(std::memory_order_relaxed);
+    }
+
+    size_t TerrainCollider::CollideSpheres(ThreadPool& pool, std::span<const shapes3D::Sphere> spheres, std::span<Vec3> correctionsOut)
+    {
+        return collideBatch(pool, spheres, correctionsOut,
+            [](const shapes3D::Sphere& s) { return s.center; },
+            [this](const shapes3D::Sphere& s, Vec3& out, QueryScratch& scratch) { return collideSphere(s, out, scratch); });
+    }
+
+    size_t TerrainCollider::CollideCapsules(ThreadPool& pool, std::span<const shapes3D::Capsule> capsules, std::span<Vec3> correctionsOut)
+    {
+        return collideBatch(pool, capsules, correctionsOut,
+            [](const shapes3D::Capsule& c) { return (c.p0 + c.p1) * 0.5f; },
+            [this](const shapes3D::Capsule& c, Vec3& out, QueryScratch& scratch) { return collideCapsule(c, out, scratch); });
+    }
+
+    bool TerrainCollider::collideSphere(const shapes3D::Sphere& s, Vec3& correctionOut, QueryScratch& scratch) const
+    {
+        AABB3 queryBox{
+            s.center - Vec3(s.radius),
+            s.center + Vec3(s.radius)
+        };
+
+        scratch.nodes.clear();
+        m_tree.QueryNodes(queryBox, scratch.nodes);
+
+        int hits = 0;
+        correctionOut = Vec3(0.0f);
+
+        for (const Tree::Node* node : scratch.nodes)
+        {
+            const BlockRange& range = m_nodeBlocks[node->userIndex];
+            for (uint32_t b = 0; b < range.count; ++b)
+                hits += SphereIntersectsTriangleBlock(s, m_blocks[range.first + b], correctionOut);
+        }
+
+        return hits > 0;
+    }
+
+    template<typename Fn>
+    void TerrainCollider::forEachTriangleInBox(const AABB3& box, QueryScratch& scratch, Fn&& fn) const
+    {
+        scratch.nodes.clear();
+        m_tree.QueryNodes(box, scratch.nodes);
+
+        for (const Tree::Node* node : scratch.nodes)
+        {
+            const BlockRange& range = m_nodeBlocks[node->userIndex];
+            for (uint32_t b = 0; b < range.count; ++b)
+            {
+                const TriangleBlock8& block = m_blocks[range.first + b];
+                for (uint32_t lane = 0; lane < block.count; ++lane)
+                {
+                    Vec3 v0(block.v0x[lane], block.v0y[lane], block.v0z[lane]);
+                    Vec3 e1(block.e1x[lane], block.e1y[lane], block.e1z[lane]);
+                    Vec3 e2(block.e2x[lane], block.e2y[lane], block.e2z[lane]);
+                    shapes::Triangle tri{ v0, v0 + e1, v0 + e2, Vec3(0.0f) };
+                    fn(block.ids[lane], tri);
+                }
+            }
+        }
+    }
+
+    bool TerrainCollider::collideCapsule(const shapes3D::Capsule& c, Vec3& correctionOut, QueryScratch& scratch) const
+    {
+        AABB3 queryBox{
+            glm::min(c.p0, c.p1) - Vec3(c.radius),
+            glm::max(c.p0, c.p1) + Vec3(c.radius)
+        };
+
+        bool collided = false;
+        correctionOut = Vec3(0.0f);
+        const float radiusSq = c.radius * c.radius;
+
+        forEachTriangleInBox(queryBox, scratch, [&](uint32_t, const shapes::Triangle& tri) {
+            Vec3 onSeg, onTri;
+            float distSq = segmentToTriangleDistanceSq(c.p0, c.p1, tri, onSeg, onTri);
+            if (distSq > radiusSq)
+                return;
+
+            float dist = std::sqrt(distSq);
+            Vec3 normal = (dist > 1e-6f) ? (onSeg - onTri) / dist
+                                         : math::Normalize(math::Cross(tri.v1 - tri.v0, tri.v2 - tri.v0));
+            correctionOut += normal * (c.radius - dist);
+            collided = true;
+        });
+
+        return collided;
+    }
+
+    uint32_t TerrainCollider::mortonCode(const Vec3& p) const {
+        // quantiza em 10 bits por eixo dentro dos limites do mundo
+        auto expandBits = [](uint32_t v) {
+            v = (v * 0x00010001u) & 0xFF0000FFu;
+            v = (v * 0x00000101u) & 0x0F00F00Fu;
+            v = (v * 0x00000011u) & 0xC30C30C3u;
+            v = (v * 0x00000005u) & 0x49249249u;
+            return v;
+        };
+
+        const Vec3 extent = m_bounds.max - m_bounds.min;
+        auto quantize = [](float v, float lo, float size) {
+            float n = size > 0.0f ? (v - lo) / size : 0.0f;
+            return static_cast<uint32_t>(std::clamp(n, 0.0f, 1.0f) * 1023.0f);
+        };
+
+        const uint32_t x = quantize(p.x, m_bounds.min.x, extent.x);
+        const uint32_t y = quantize(p.y, m_bounds.min.y, extent.y);
+        const uint32_t z = quantize(p.z, m_bounds.min.z, extent.z);
+        return (expandBits(x) << 2) | (expandBits(y) << 1) | expandBits(z);
+    }
+
+    bool TerrainCollider::SweepSphere(const Vec3& start, const Vec3& end, float radius, SweepHit3& outHit)
+    {
+        requireBuilt();
+
+        const Vec3 delta = end - start;
+        AABB3 sweptBox{
+            glm::min(start, end) - Vec3(radius),
+            glm::max(start, end) + Vec3(radius)
+        };
+
+        bool found = false;
+        float best = 1.0f;
+        Vec3 bestContact(0.0f);
+        Vec3 bestFaceNormal(0.0f);
+        uint32_t bestId = UINT32_MAX;
+
+        FrameArena::Scope arena;
+        QueryScratch scratch(arena.Resource());
+        forEachTriangleInBox(sweptBox, scratch, [&](uint32_t id, const shapes::Triangle& tri) {
+            float t;
+            Vec3 contact;
+            if (!sweptSphereIntersectsTriangle(start, delta, radius, tri, best, t, contact))
+                return;
+            if (found && t >= best)
+                return;
+
+            found = true;
+            best = t;
+            bestContact = contact;
+            bestFaceNormal = math::Cross(tri.v1 - tri.v0, tri.v2 - tri.v0);
+            bestId = id;
+        });
+
+        if (!found)
+            return false;
+
+        const Vec3 center = start + delta * best;
+        Vec3 normal = center - bestContact;
+        float len = math::Length(normal);
+        if (len > 1e-6f) {
+            normal = normal / len;
+        } else {
+            // centro sobre a face: normal da face voltada para o lado de onde a esfera veio
+            normal = math::Normalize(bestFaceNormal);
+            if (math::Dot(normal, delta) > 0.0f) normal = -normal;
+        }
+
+        outHit.hit = true;
+        outHit.toi = best;
+        outHit.position = center;
+        outHit.contact = bestContact;
+        outHit.normal = normal;
+        outHit.triangleId = bestId;
+        return true;
+    }
+
+    bool TerrainCollider::SweepCapsule(const shapes3D::Capsule& capsule, const Vec3& delta, SweepHit3& outHit)
+    {
+        requireBuilt();
+
+        const Vec3 segMin = glm::min(capsule.p0, capsule.p1);
+        const Vec3 segMax = glm::max(capsule.p0, capsule.p1);
+        AABB3 sweptBox{
+            glm::min(segMin, segMin + delta) - Vec3(capsule.radius),
+            glm::max(segMax, segMax + delta) + Vec3(capsule.radius)
+        };
+
+        bool found = false;
+        float best = 1.0f;
+        shapes::Triangle bestTriangle{};
+        uint32_t bestId = UINT32_MAX;
+
+        FrameArena::Scope arena;
+        QueryScratch scratch(arena.Resource());
+        forEachTriangleInBox(sweptBox, scratch, [&](uint32_t id, const shapes::Triangle& tri) {
+            float t;
+            if (!sweptCapsuleIntersectsTriangle(capsule.p0, capsule.p1, delta, capsule.radius, tri, best, t))
+                return;
+            if (found && t >= best)
+                return;
+
+            found = true;
+            best = t;
+            bestTriangle = tri;
+            bestId = id;
+        });
+
+        if (!found)
+            return false;
+
+        // pontos de contato na posição do impacto
+        const Vec3 offset = delta * best;
+        Vec3 bestSeg, bestTri;
+        segmentToTriangleDistanceSq(capsule.p0 + offset, capsule.p1 + offset, bestTriangle, bestSeg, bestTri);
+        const Vec3 bestFaceNormal = math::Cross(bestTriangle.v1 - bestTriangle.v0, bestTriangle.v2 - bestTriangle.v0);
+
+        Vec3 normal = bestSeg - bestTri;
+        float len = math::Length(normal);
+        if (len > 1e-6f) {
+            normal = normal / len;
+        } else {
+            normal = math::Normalize(bestFaceNormal);
+            if (math::Dot(normal, delta) > 0.0f) normal = -normal;
+        }
+
+        outHit.hit = true;
+        outHit.toi = best;
+        outHit.position = delta * best;
+        outHit.contact = bestTri;
+        outHit.normal = normal;
+        outHit.triangleId = bestId;
+        return true;
+    }
+
+    bool TerrainCollider::Raycast(const Vec3& origin, const Vec3& dir, float maxDist, RayHit3& outHit) {
+        requireBuilt();
+
+        Vec3 end = origin + dir * maxDist;
+        Vec3 qmin = glm::min(origin, end);
+        Vec3 qmax = glm::max(origin, end);
+        AABB3 queryBox{ qmin, qmax };
+
+        FrameArena::Scope arena;
+        std::pmr::vector<const Tree::Node*> candidates(arena.Resource());
+        m_tree.QueryNodes(queryBox, candidates);
+
+        const TriangleBlock8* bestBlock = nullptr;
+        int bestLane = -1;
+        float bestT = maxDist;
+
+        for (const Tree::Node* node : candidates) {
+            const BlockRange& range = m_nodeBlocks[node->userIndex];
+            for (uint32_t b = 0; b < range.count; ++b) {
+                const TriangleBlock8& block = m_blocks[range.first + b];
+                if (RayIntersectsTriangleBlock(origin, dir, block, bestT, bestLane))
+                    bestBlock = &block;
+            }
+        }
+
+        if (!bestBlock)
+            return false;
+
+        Vec3 e1(bestBlock->e1x[bestLane], bestBlock->e1y[bestLane], bestBlock->e1z[bestLane]);
+        Vec3 e2(bestBlock->e2x[bestLane], bestBlock->e2y[bestLane], bestBlock->e2z[bestLane]);
+
+        outHit.hit = true;
+        outHit.distance = bestT;
+        outHit.triangleId = bestBlock->ids[bestLane];
+        outHit.normal = math::Normalize(math::Cross(e1, e2));
+        outHit.position = origin + dir * bestT;
+        return true;
+    }
+}
@@ -0,0 +1,15 @@
+#define CP_TERRAIN_KERNELS_TABLE TriangleKernelsBaseline
+#include "cp_api/physics/terrainKernels.inl"
+
+namespace cp_api::physics {
+
+    const TriangleKernels& GetTriangleKernels() {
+#if defined(CP_SIMD_HAS_AVX2_KERNELS)
+        static const TriangleKernels& kernels = simd::HasAVX2() ? TriangleKernelsAVX2 : TriangleKernelsBaseline;
+        return kernels;
+#else
+        return TriangleKernelsBaseline;
+#endif
+    }
+
+} // namespace cp_api::physics
@@ -0,0 +1,3 @@
+// Compilado com AVX2 + FMA (ver CMakeLists); só é chamado se simd::HasAVX2().
+#define CP_TERRAIN_KERNELS_TABLE TriangleKernelsAVX2
+#include "cp_api/physics/terrainKernels.inl"
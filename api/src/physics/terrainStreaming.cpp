@@ -0,0 +1,494 @@
+#include "cp_api/physics/terrainStreaming.hpp"
+#include "cp_api/core/threadPool.hpp"
+#include "cp_api/core/diagnostics.hpp"
+#include "cp_api/core/filesystem.hpp"
+#include "cp_api/core/compression.hpp"
+#include "cp_api/core/debug.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+
+namespace cp_api::physics {
+
+    namespace {
+        // ---------------------------
+        // Formato do tile cozido (antes da compressão):
+        // [TileHeader] [vertexCount * 3 floats] [indexCount * uint32]
+        // ---------------------------
+        constexpr uint32_t TileMagic = 0x54545043; // "CPTT"
+        constexpr uint32_t TileVersion = 1;
+
+        struct TileHeader {
+            uint32_t magic = TileMagic;
+            uint32_t version = TileVersion;
+            uint32_t vertexCount = 0;
+            uint32_t indexCount = 0;
+        };
+
+        constexpr float BoundsPadding = 1.0f;
+
+        // nova tentativa após uma falha de carga: dobra a cada falha, até o teto
+        constexpr std::chrono::milliseconds RetryBaseDelay{ 500 };
+        constexpr std::chrono::milliseconds RetryMaxDelay{ 30000 };
+
+        // incrementado por CookTile: managers esquecem os tiles que não tinham arquivo
+        std::atomic<uint64_t> g_cookGeneration{ 0 };
+    }
+
+    TerrainTileManager::TerrainTileManager(ThreadPool& pool, TerrainStreamingConfig config)
+        : m_pool(pool), m_config(std::move(config))
+    {
+        if (m_config.tileSize <= 0.0f)
+            CP_LOG_THROW("TerrainTileManager: tileSize deve ser positivo ({})", m_config.tileSize);
+    }
+
+    // as tarefas pendentes só capturam o caminho do arquivo, então não precisam ser aguardadas
+    TerrainTileManager::~TerrainTileManager() = default;
+
+    // ------------------------------------------------------------
+    // Cozimento
+    // ------------------------------------------------------------
+    std::filesystem::path TerrainTileManager::TilePath(const std::filesystem::path& directory, TerrainTileCoord coord) {
+        return directory / ("tile_" + std::to_string(coord.x) + "_" + std::to_string(coord.z) + ".cpterrain");
+    }
+
+    void TerrainTileManager::CookTile(const std::filesystem::path& file,
+                                      std::span<const Vec3> vertices, std::span<const uint32_t> indices)
+    {
+        TileHeader header;
+        header.vertexCount = static_cast<uint32_t>(vertices.size());
+        header.indexCount = static_cast<uint32_t>(indices.size());
+
+        const size_t vertexBytes = vertices.size() * 3 * sizeof(float);
+        const size_t indexBytes = indices.size() * sizeof(uint32_t);
+
+        std::vector<uint8_t> raw(sizeof(TileHeader) + vertexBytes + indexBytes);
+        uint8_t* dst = raw.data();
+        std::memcpy(dst, &header, sizeof(TileHeader));
+        dst += sizeof(TileHeader);
+
+        for (const Vec3& v : vertices) {
+            const float xyz[3] = { v.x, v.y, v.z };
+            std::memcpy(dst, xyz, sizeof(xyz));
+            dst += sizeof(xyz);
+        }
+        if (indexBytes)
+            std::memcpy(dst, indices.data(), indexBytes);
+
+        auto compressed = compression::CompressData(raw);
+        if (compressed.empty())
+            CP_LOG_THROW("Falha ao comprimir tile de terreno: {}", file.string());
+
+        filesystem::WriteBytes(file, compressed);
+        g_cookGeneration.fetch_add(1, std::memory_order_release);
+    }
+
+    size_t TerrainTileManager::CookTiles(const std::filesystem::path& directory, float tileSize,
+                                         std::span<const Vec3> vertices, std::span<const uint32_t> indices)
+    {
+        if (indices.size() % 3 != 0)
+            CP_LOG_THROW("CookTiles: quantidade de índices ({}) não é múltipla de 3", indices.size());
+
+        struct TileMesh {
+            TerrainTileCoord coord;
+            std::vector<Vec3> vertices;
+            std::vector<uint32_t> indices;
+            std::unordered_map<uint32_t, uint32_t> remap; // índice global -> local
+        };
+
+        std::unordered_map<uint64_t, TileMesh> tiles;
+
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            uint32_t tri[3] = { indices[i], indices[i + 1], indices[i + 2] };
+            for (uint32_t idx : tri) {
+                if (idx >= vertices.size())
+                    CP_LOG_THROW("CookTiles: índice {} fora do intervalo ({} vértices)", idx, vertices.size());
+            }
+
+            Vec3 centroid = (vertices[tri[0]] + vertices[tri[1]] + vertices[tri[2]]) / 3.0f;
+            TerrainTileCoord coord{
+                static_cast<int32_t>(std::floor(centroid.x / tileSize)),
+                static_cast<int32_t>(std::floor(centroid.z / tileSize))
+            };
+
+            TileMesh& mesh = tiles[coord.Key()];
+            mesh.coord = coord;
+            for (uint32_t idx : tri) {
+                auto [it, inserted] = mesh.remap.try_emplace(idx, static_cast<uint32_t>(mesh.vertices.size()));
+                if (inserted) mesh.vertices.push_back(vertices[idx]);
+                mesh.indices.push_back(it->second);
+            }
+        }
+
+        for (const auto& [key, mesh] : tiles)
+            CookTile(TilePath(directory, mesh.coord), mesh.vertices, mesh.indices);
+
+        return tiles.size();
+    }
+
+    std::unique_ptr<TerrainCollider> TerrainTileManager::LoadTile(const std::filesystem::path& file)
+    {
+        auto [owner, bytes] = filesystem::ReadBytesAuto(file);
+        std::vector<uint8_t> raw = compression::UncompressData(bytes);
+        if (raw.size() < sizeof(TileHeader))
+            CP_LOG_THROW("Tile de terreno inválido: {}", file.string());
+
+        TileHeader header;
+        std::memcpy(&header, raw.data(), sizeof(TileHeader));
+        if (header.magic != TileMagic || header.version != TileVersion)
+            CP_LOG_THROW("Tile de terreno com formato desconhecido: {}", file.string());
+
+        const size_t vertexBytes = size_t(header.vertexCount) * 3 * sizeof(float);
+        const size_t indexBytes = size_t(header.indexCount) * sizeof(uint32_t);
+        if (raw.size() != sizeof(TileHeader) + vertexBytes + indexBytes)
+            CP_LOG_THROW("Tile de terreno truncado: {}", file.string());
+
+        const uint8_t* src = raw.data() + sizeof(TileHeader);
+        std::vector<Vec3> vertices(header.vertexCount);
+        Vec3 bmin(std::numeric_limits<float>::max());
+        Vec3 bmax(std::numeric_limits<float>::lowest());
+        for (Vec3& v : vertices) {
+            float xyz[3];
+            std::memcpy(xyz, src, sizeof(xyz));
+            src += sizeof(xyz);
+            v = Vec3(xyz[0], xyz[1], xyz[2]);
+            bmin = glm::min(bmin, v);
+            bmax = glm::max(bmax, v);
+        }
+
+        std::vector<uint32_t> indices(header.indexCount);
+        if (indexBytes)
+            std::memcpy(indices.data(), src, indexBytes);
+
+        if (vertices.empty()) {
+            bmin = Vec3(0.0f);
+            bmax = Vec3(0.0f);
+        }
+
+        auto collider = std::make_unique<TerrainCollider>(AABB3(bmin - Vec3(BoundsPadding), bmax + Vec3(BoundsPadding)));
+        collider->AddMesh(vertices, indices);
+        collider->Build(); // blocos SoA prontos antes de entrar na thread de física
+        return collider;
+    }
+
+    // ------------------------------------------------------------
+    // Residência
+    // ------------------------------------------------------------
+    TerrainTileCoord TerrainTileManager::TileAt(const Vec3& p) const {
+        return {
+            static_cast<int32_t>(std::floor(p.x / m_config.tileSize)),
+            static_cast<int32_t>(std::floor(p.z / m_config.tileSize))
+        };
+    }
+
+    float TerrainTileManager::distanceToTile(TerrainTileCoord coord, std::span<const Vec3> focusPoints) const {
+        const float size = m_config.tileSize;
+        const float minX = coord.x * size, maxX = minX + size;
+        const float minZ = coord.z * size, maxZ = minZ + size;
+
+        float best = std::numeric_limits<float>::max();
+        for (const Vec3& p : focusPoints) {
+            float dx = std::max({ minX - p.x, 0.0f, p.x - maxX });
+            float dz = std::max({ minZ - p.z, 0.0f, p.z - maxZ });
+            best = std::min(best, std::sqrt(dx * dx + dz * dz));
+        }
+        return best;
+    }
+
+    void TerrainTileManager::Update(std::span<const Vec3> focusPoints) {
+        // algum tile foi cozido: os que faltavam (ou falhavam) podem existir agora
+        const uint64_t cookGeneration = g_cookGeneration.load(std::memory_order_acquire);
+        if (cookGeneration != m_cookGeneration) {
+            m_cookGeneration = cookGeneration;
+            m_missing.clear();
+            m_failed.clear();
+        }
+
+        refreshOverBudget(focusPoints);
+        collectFinishedLoads(focusPoints);
+        evict(focusPoints);
+        scheduleLoads(focusPoints);
+    }
+
+    void TerrainTileManager::refreshOverBudget(std::span<const Vec3> focusPoints) {
+        std::vector<uint64_t> focusTiles;
+        focusTiles.reserve(focusPoints.size());
+        for (const Vec3& p : focusPoints)
+            focusTiles.push_back(TileAt(p).Key());
+
+        // foco mudou de tile: as distâncias mudaram, todos voltam a concorrer
+        if (focusTiles != m_focusTiles) {
+            m_overBudget.clear();
+            m_focusTiles = std::move(focusTiles);
+            return;
+        }
+
+        // uso caiu: quem cabe agora pode ser carregado de novo
+        for (auto it = m_overBudget.begin(); it != m_overBudget.end();) {
+            if (m_memoryUsage + it->second <= m_config.memoryBudgetBytes)
+                it = m_overBudget.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    void TerrainTileManager::collectFinishedLoads(std::span<const Vec3> focusPoints) {
+        const float keepRadius = m_config.residencyRadius + m_config.unloadMargin;
+
+        for (auto it = m_pending.begin(); it != m_pending.end();) {
+            PendingTile& pending = it->second;
+            if (pending.future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++it;
+                continue;
+            }
+
+            std::unique_ptr<TerrainCollider> collider;
+            try {
+                collider = pending.future.get();
+                m_failed.erase(it->first);
+            } catch (const std::exception& e) {
+                // erro de I/O ou arquivo sendo escrito: tenta de novo mais tarde, não para sempre
+                FailedLoad& failed = m_failed[it->first];
+                const uint32_t shift = std::min<uint32_t>(failed.attempts, 16);
+                const auto delay = std::min<std::chrono::milliseconds>(RetryBaseDelay * (1u << shift), RetryMaxDelay);
+                ++failed.attempts;
+                failed.retryAt = std::chrono::steady_clock::now() + delay;
+                CP_LOG_ERROR("Falha ao carregar tile de terreno ({}, {}), tentativa {}, nova tentativa em {} ms: {}",
+                             pending.coord.x, pending.coord.z, failed.attempts, delay.count(), e.what());
+            }
+
+            // o foco pode ter se afastado enquanto o tile carregava
+            const float dist = collider ? distanceToTile(pending.coord, focusPoints) : 0.0f;
+            if (collider && dist <= keepRadius) {
+                const size_t memory = collider->GetMemoryUsage();
+
+                // checa o orçamento antes de entrar: o evict descartaria o tile recém-carregado
+                if (makeRoom(memory, dist, focusPoints)) {
+                    Tile tile;
+                    tile.coord = pending.coord;
+                    tile.bounds = collider->GetBounds();
+                    tile.memory = memory;
+                    tile.collider = std::move(collider);
+
+                    m_memoryUsage += tile.memory;
+                    m_resident.emplace(it->first, std::move(tile));
+                } else {
+                    m_overBudget[it->first] = memory;
+                }
+            }
+
+            it = m_pending.erase(it);
+        }
+    }
+
+    bool TerrainTileManager::makeRoom(size_t memory, float distance, std::span<const Vec3> focusPoints) {
+        if (m_memoryUsage + memory <= m_config.memoryBudgetBytes)
+            return true;
+
+        // só cede quem está mais longe que o tile novo (e nunca o tile sob um foco)
+        std::vector<std::pair<float, uint64_t>> farther;
+        size_t reclaimable = 0;
+        for (const auto& [key, tile] : m_resident) {
+            const float dist = distanceToTile(tile.coord, focusPoints);
+            if (dist > distance && dist > 0.0f) {
+                farther.emplace_back(dist, key);
+                reclaimable += tile.memory;
+            }
+        }
+
+        // o tile sob um foco sempre entra, como no evict
+        if (distance > 0.0f && m_memoryUsage - reclaimable + memory > m_config.memoryBudgetBytes)
+            return false;
+
+        std::sort(farther.begin(), farther.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (const auto& [dist, key] : farther) {
+            if (m_memoryUsage + memory <= m_config.memoryBudgetBytes)
+                break;
+            auto it = m_resident.find(key);
+            m_memoryUsage -= it->second.memory;
+            m_overBudget[key] = it->second.memory;
+            m_resident.erase(it);
+        }
+        return true;
+    }
+
+    void TerrainTileManager::evict(std::span<const Vec3> focusPoints) {
+        const float keepRadius = m_config.residencyRadius + m_config.unloadMargin;
+
+        std::vector<std::pair<float, uint64_t>> byDistance;
+        byDistance.reserve(m_resident.size());
+
+        for (auto it = m_resident.begin(); it != m_resident.end();) {
+            float dist = distanceToTile(it->second.coord, focusPoints);
+            if (dist > keepRadius) {
+                m_memoryUsage -= it->second.memory;
+                it = m_resident.erase(it);
+                continue;
+            }
+            byDistance.emplace_back(dist, it->first);
+            ++it;
+        }
+
+        if (m_memoryUsage <= m_config.memoryBudgetBytes)
+            return;
+
+        // acima do orçamento: descarta os mais distantes, mas nunca o tile sob um foco
+        std::sort(byDistance.begin(), byDistance.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (const auto& [dist, key] : byDistance) {
+            if (m_memoryUsage <= m_config.memoryBudgetBytes || dist <= 0.0f)
+                break;
+            auto it = m_resident.find(key);
+            m_memoryUsage -= it->second.memory;
+            m_overBudget[key] = it->second.memory;
+            m_resident.erase(it);
+        }
+    }
+
+    void TerrainTileManager::scheduleLoads(std::span<const Vec3> focusPoints) {
+        if (focusPoints.empty() || m_pending.size() >= m_config.maxLoadsInFlight)
+            return;
+
+        const auto now = std::chrono::steady_clock::now();
+
+        // candidatos dentro do raio de residência, do mais próximo ao mais distante
+        std::vector<std::pair<float, TerrainTileCoord>> candidates;
+        const int32_t range = static_cast<int32_t>(std::ceil(m_config.residencyRadius / m_config.tileSize));
+
+        for (const Vec3& p : focusPoints) {
+            TerrainTileCoord center = TileAt(p);
+            for (int32_t dz = -range; dz <= range; ++dz) {
+                for (int32_t dx = -range; dx <= range; ++dx) {
+                    TerrainTileCoord coord{ center.x + dx, center.z + dz };
+                    uint64_t key = coord.Key();
+                    if (m_resident.count(key) || m_pending.count(key) || m_missing.count(key) || m_overBudget.count(key))
+                        continue;
+
+                    auto failed = m_failed.find(key);
+                    if (failed != m_failed.end() && now < failed->second.retryAt)
+                        continue;
+
+                    float dist = distanceToTile(coord, focusPoints);
+                    if (dist <= m_config.residencyRadius)
+                        candidates.emplace_back(dist, coord);
+                }
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        // estimativa de custo de um tile novo: média dos residentes
+        const size_t averageTile = m_resident.empty() ? 0 : m_memoryUsage / m_resident.size();
+
+        for (const auto& [dist, coord] : candidates) {
+            if (m_pending.size() >= m_config.maxLoadsInFlight)
+                break;
+
+            uint64_t key = coord.Key();
+            if (m_pending.count(key))
+                continue; // repetido por mais de um foco
+
+            if (m_memoryUsage + (m_pending.size() + 1) * averageTile > m_config.memoryBudgetBytes)
+                break;
+
+            std::filesystem::path file = TilePath(m_config.directory, coord);
+            if (!filesystem::FileExists(file)) {
+                m_missing.insert(key);
+                continue;
+            }
+
+            PendingTile pending;
+            pending.coord = coord;
+            pending.future = m_pool.Submit(TaskPriority::BACKGROUND, [file]() { return LoadTile(file); });
+            m_pending.emplace(key, std::move(pending));
+        }
+    }
+
+    void TerrainTileManager::ReportDiagnostics(DiagnosticsManager& diagnostics) const {
+        diagnostics.ReportMemory("TerrainTiles", m_memoryUsage, m_config.memoryBudgetBytes);
+    }
+
+    // ------------------------------------------------------------
+    // Consultas
+    // ------------------------------------------------------------
+    bool TerrainTileManager::CollideSphere(shapes3D::Sphere& s, Vec3& correctionOut) {
+        AABB3 box{ s.center - Vec3(s.radius), s.center + Vec3(s.radius) };
+
+        bool collided = false;
+        correctionOut = Vec3(0.0f);
+        for (auto& [key, tile] : m_resident) {
+            if (!tile.bounds.Intersects(box))
+                continue;
+
+            Vec3 correction;
+            if (tile.collider->CollideSphere(s, correction)) {
+                correctionOut += correction;
+                collided = true;
+            }
+        }
+        return collided;
+    }
+
+    bool TerrainTileManager::CollideCapsule(shapes3D::Capsule& c, Vec3& correctionOut) {
+        AABB3 box{
+            glm::min(c.p0, c.p1) - Vec3(c.radius),
+            glm::max(c.p0, c.p1) + Vec3(c.radius)
+        };
+
+        bool collided = false;
+        correctionOut = Vec3(0.0f);
+        for (auto& [key, tile] : m_resident) {
+            if (!tile.bounds.Intersects(box))
+                continue;
+
+            Vec3 correction;
+            if (tile.collider->CollideCapsule(c, correction)) {
+                correctionOut += correction;
+                collided = true;
+            }
+        }
+        return collided;
+    }
+
+    bool TerrainTileManager::Raycast(const Vec3& origin, const Vec3& dir, float maxDist, RayHit3& outHit, TerrainTileCoord* outTile) {
+        Vec3 end = origin + dir * maxDist;
+        AABB3 box{ glm::min(origin, end), glm::max(origin, end) };
+
+        bool found = false;
+        float best = maxDist;
+        for (auto& [key, tile] : m_resident) {
+            if (!tile.bounds.Intersects(box))
+                continue;
+
+            RayHit3 hit;
+            if (tile.collider->Raycast(origin, dir, best, hit) && hit.distance <= best) {
+                best = hit.distance;
+                outHit = hit;
+                if (outTile) *outTile = tile.coord;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    bool TerrainTileManager::SweepSphere(const Vec3& start, const Vec3& end, float radius, SweepHit3& outHit, TerrainTileCoord* outTile) {
+        AABB3 box{
+            glm::min(start, end) - Vec3(radius),
+            glm::max(start, end) + Vec3(radius)
+        };
+
+        bool found = false;
+        for (auto& [key, tile] : m_resident) {
+            if (!tile.bounds.Intersects(box))
+                continue;
+
+            SweepHit3 hit;
+            if (tile.collider->SweepSphere(start, end, radius, hit) && (!found || hit.toi < outHit.toi)) {
+                outHit = hit;
+                if (outTile) *outTile = tile.coord;
+                found = true;
+            }
+        }
+        return found;
+    }
+}
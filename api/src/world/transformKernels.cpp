@@ -0,0 +1,15 @@
+#define CP_TRANSFORM_KERNELS_TABLE TransformKernelsBaseline
+#include "cp_api/world/transformKernels.inl"
+
+namespace cp_api {
+
+    const TransformKernels& GetTransformKernels() {
+#if defined(CP_SIMD_HAS_AVX2_KERNELS)
+        static const TransformKernels& kernels = simd::HasAVX2() ? TransformKernelsAVX2 : TransformKernelsBaseline;
+        return kernels;
+#else
+        return TransformKernelsBaseline;
+#endif
+    }
+
+} // namespace cp_api
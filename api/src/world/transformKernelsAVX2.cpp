@@ -0,0 +1,3 @@
+// Compilado com AVX2 + FMA (ver CMakeLists); só é chamado se simd::HasAVX2().
+#define CP_TRANSFORM_KERNELS_TABLE TransformKernelsAVX2
+#include "cp_api/world/transformKernels.inl"
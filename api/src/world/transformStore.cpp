@@ -0,0 +1,227 @@
+#include "cp_api/world/transformStore.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace cp_api {
+    uint32_t TransformStore::Allocate(uint32_t entity, const Vec3& position, const Quat& rotation, const Vec3& scale,
+                                      const physics3D::AABB& localBounds) {
+        if (m_freeSlots.empty()) {
+            const uint32_t first = static_cast<uint32_t>(GetSlotCount());
+            m_blocks.emplace_back();
+            m_live.push_back(0);
+            m_dirty.push_back(0);
+            m_root.push_back(0);
+            m_entities.resize(GetSlotCount(), 0);
+
+            // do fim para o começo: os slots saem em ordem
+            for (uint32_t l = Width; l-- > 0;)
+                m_freeSlots.push_back(first + l);
+        }
+
+        const uint32_t slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+
+        m_entities[slot] = entity;
+        m_live[slot / Width] |= uint8_t(1u << lane(slot));
+        SetRoot(slot, true);
+
+        Block& b = block(slot);
+        const uint32_t l = lane(slot);
+        for (int i = 0; i < 3; ++i) {
+            b.pos[i][l] = position[i];
+            b.scale[i][l] = scale[i];
+        }
+        b.rot[0][l] = rotation.x; b.rot[1][l] = rotation.y; b.rot[2][l] = rotation.z; b.rot[3][l] = rotation.w;
+        SetLocalBounds(slot, localBounds);
+
+        // o próximo ComposeBlocks recalcula a lane pelo kernel; o escalar só serve até lá
+        composeLane(slot);
+        return slot;
+    }
+
+    void TransformStore::Release(uint32_t slot) {
+        const uint8_t bit = uint8_t(1u << lane(slot));
+        m_live[slot / Width] &= uint8_t(~bit);
+        m_dirty[slot / Width] &= uint8_t(~bit);
+        m_root[slot / Width] &= uint8_t(~bit);
+        m_entities[slot] = 0;
+        m_freeSlots.push_back(slot);
+    }
+
+    physics3D::AABB TransformStore::GetLocalBounds(uint32_t slot) const {
+        const Block& b = block(slot);
+        const uint32_t l = lane(slot);
+        const Vec3 center(b.center[0][l], b.center[1][l], b.center[2][l]);
+        const Vec3 extents(b.extents[0][l], b.extents[1][l], b.extents[2][l]);
+        return physics3D::AABB(center - extents, center + extents);
+    }
+
+    physics3D::AABB TransformStore::GetWorldBounds(uint32_t slot) const {
+        const Block& b = block(slot);
+        const uint32_t l = lane(slot);
+        return physics3D::AABB(Vec3(b.boundsMin[0][l], b.boundsMin[1][l], b.boundsMin[2][l]),
+                               Vec3(b.boundsMax[0][l], b.boundsMax[1][l], b.boundsMax[2][l]));
+    }
+
+    void TransformStore::SetPosition(uint32_t slot, const Vec3& value) {
+        Block& b = block(slot);
+        const uint32_t l = lane(slot);
+        b.pos[0][l] = value.x; b.pos[1][l] = value.y; b.pos[2][l] = value.z;
+        MarkDirty(slot);
+    }
+
+    void TransformStore::SetRotation(uint32_t slot, const Quat& value) {
+        Block& b = block(slot);
+        const uint32_t l = lane(slot);
+        b.rot[0][l] = value.x; b.rot[1][l] = value.y; b.rot[2][l] = value.z; b.rot[3][l] = value.w;
+        MarkDirty(slot);
+    }
+
+    void TransformStore::SetScale(uint32_t slot, const Vec3& value) {
+        Block& b = block(slot);
+        const uint32_t l = lane(slot);
+        b.scale[0][l] = value.x; b.scale[1][l] = value.y; b.scale[2][l] = value.z;
+        MarkDirty(slot);
+    }
+
+    void TransformStore::SetLocalBounds(uint32_t slot, const physics3D::AABB& bounds) {
+        Block& b = block(slot);
+        const uint32_t l = lane(slot);
+        const Vec3 center = bounds.Center();
+        const Vec3 extents = bounds.Extents();
+        for (int i = 0; i < 3; ++i) {
+            b.center[i][l] = center[i];
+            b.extents[i][l] = extents[i];
+        }
+        MarkDirty(slot);
+    }
+
+    void TransformStore::SetRoot(uint32_t slot, bool root) {
+        const uint8_t bit = uint8_t(1u << lane(slot));
+        if (root) m_root[slot / Width] |= bit;
+        else m_root[slot / Width] &= uint8_t(~bit);
+    }
+
+    void TransformStore::ClearDirty() {
+        std::fill(m_dirty.begin(), m_dirty.end(), uint8_t(0));
+    }
+
+    void TransformStore::ComposeBlocks(size_t begin, size_t end, std::vector<BoundsChange>& outChanges) {
+        using namespace simd;
+        alignas(32) float newMin[3][Width];
+        alignas(32) float newMax[3][Width];
+
+        for (size_t bi = begin; bi < end; ++bi) {
+            const int dirty = m_dirty[bi];
+            if (dirty == 0) continue;
+
+            Block& b = m_blocks[bi];
+            GetTransformKernels().composeBlock(b, newMin, newMax);
+
+            // bounds daqui só valem para raízes; as dos filhos saem do ComposeWorld
+            const int rootDirty = dirty & m_root[bi];
+            if (rootDirty == 0) continue;
+
+            // raízes sujas cujas bounds mudaram
+            Mask8 differs = MaskFromBits(0);
+            for (int i = 0; i < 3; ++i) {
+                const Float8 oldMin = Load(b.boundsMin[i]), oldMax = Load(b.boundsMax[i]);
+                const Float8 nMin = Load(newMin[i]), nMax = Load(newMax[i]);
+                differs = differs | (nMin < oldMin) | (nMin > oldMin) | (nMax < oldMax) | (nMax > oldMax);
+            }
+
+            for (int changed = MoveMask(differs) & rootDirty; changed != 0; changed &= changed - 1) {
+                const int l = std::countr_zero(static_cast<unsigned>(changed));
+                outChanges.push_back({
+                    m_entities[bi * Width + l],
+                    physics3D::AABB(Vec3(b.boundsMin[0][l], b.boundsMin[1][l], b.boundsMin[2][l]),
+                                    Vec3(b.boundsMax[0][l], b.boundsMax[1][l], b.boundsMax[2][l])),
+                    physics3D::AABB(Vec3(newMin[0][l], newMin[1][l], newMin[2][l]),
+                                    Vec3(newMax[0][l], newMax[1][l], newMax[2][l]))
+                });
+            }
+
+            // só as raízes sujas: as outras continuam com as bounds que a árvore conhece
+            const Mask8 dirtyMask = MaskFromBits(rootDirty);
+            for (int i = 0; i < 3; ++i) {
+                Store(b.boundsMin[i], Select(dirtyMask, Load(newMin[i]), Load(b.boundsMin[i])));
+                Store(b.boundsMax[i], Select(dirtyMask, Load(newMax[i]), Load(b.boundsMax[i])));
+            }
+        }
+    }
+
+    void TransformStore::ComposeWorld(uint32_t slot, uint32_t parentSlot, std::vector<BoundsChange>& outChanges) {
+        const Block& pb = block(parentSlot);
+        const uint32_t pl = lane(parentSlot);
+        const auto& parentWorld = IsRoot(parentSlot) ? pb.local : pb.world;
+        Block& b = block(slot);
+        const uint32_t l = lane(slot);
+
+        float p[12], m[12];
+        for (int k = 0; k < 12; ++k) {
+            p[k] = parentWorld[k][pl];
+            m[k] = b.local[k][l];
+        }
+
+        // afim 4x3: base = P.base * M.base; translação = P.base * M.t + P.t
+        for (int col = 0; col < 4; ++col) {
+            for (int row = 0; row < 3; ++row) {
+                float v = p[row] * m[col * 3] + p[3 + row] * m[col * 3 + 1] + p[6 + row] * m[col * 3 + 2];
+                if (col == 3) v += p[9 + row];
+                b.world[col * 3 + row][l] = v;
+            }
+        }
+
+        // bounds de mundo pela matriz composta (centro transformado, extents pela base absoluta)
+        float newMin[3], newMax[3];
+        bool changed = false;
+        for (int row = 0; row < 3; ++row) {
+            float center = b.world[9 + row][l];
+            float extent = 0.0f;
+            for (int col = 0; col < 3; ++col) {
+                const float w = b.world[col * 3 + row][l];
+                center += w * b.center[col][l];
+                extent += std::abs(w) * b.extents[col][l];
+            }
+            newMin[row] = center - extent;
+            newMax[row] = center + extent;
+            changed |= newMin[row] != b.boundsMin[row][l] || newMax[row] != b.boundsMax[row][l];
+        }
+        if (!changed) return;
+
+        outChanges.push_back({ m_entities[slot], GetWorldBounds(slot),
+                               physics3D::AABB(Vec3(newMin[0], newMin[1], newMin[2]), Vec3(newMax[0], newMax[1], newMax[2])) });
+        for (int row = 0; row < 3; ++row) {
+            b.boundsMin[row][l] = newMin[row];
+            b.boundsMax[row][l] = newMax[row];
+        }
+    }
+
+    Mat4 TransformStore::toMat4(const float (&m)[12][Width], uint32_t lane) {
+        Mat4 result(1.0f);
+        for (int col = 0; col < 4; ++col)
+            for (int row = 0; row < 3; ++row)
+                result[col][row] = m[col * 3 + row][lane];
+        return result;
+    }
+
+    void TransformStore::composeLane(uint32_t slot) {
+        // mesmo kernel numa cópia do bloco: resultado idêntico ao do ComposeBlocks, sem mexer
+        // nas bounds das outras lanes (que ainda podem estar esperando o sync)
+        Block& b = block(slot);
+        const uint32_t l = lane(slot);
+
+        Block scratch = b;
+        GetTransformKernels().composeBlock(scratch, scratch.boundsMin, scratch.boundsMax);
+
+        for (int k = 0; k < 12; ++k)
+            b.local[k][l] = scratch.local[k][l];
+        for (int i = 0; i < 3; ++i) {
+            b.boundsMin[i][l] = scratch.boundsMin[i][l];
+            b.boundsMax[i][l] = scratch.boundsMax[i][l];
+        }
+    }
+
+} // namespace cp_api
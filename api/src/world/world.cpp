@@ -1,10 +1,13 @@
 #include "cp_api/world/world.hpp"
 #include "cp_api/components/transformComponent.hpp"
+#include "cp_api/core/parallel.hpp"
 #include "cp_api/core/debug.hpp"
 
+#include <algorithm>
+
 namespace cp_api {
-    World::World() 
-        : m_worldSpace(physics3D::AABB(Vec3(-10'000), Vec3(10'000))) {
+    World::World(ThreadPool* threadPool)
+        : m_worldSpace(physics3D::AABB(Vec3(-10'000), Vec3(10'000))), m_threadPool(threadPool) {
 
         setupCallbacks();
     }
@@ -20,6 +23,174 @@ namespace cp_api {
 
     }
 
+    size_t World::SyncTransforms() {
+        const size_t blocks = m_transforms.GetBlockCount();
+        if (blocks == 0) return 0;
+
+        // um buffer por faixa de SyncChunkBlocks blocos: cada faixa é escrita por uma tarefa só,
+        // seja qual for a thread (workers ou threads de fora ajudando no Wait)
+        const size_t chunks = (blocks + SyncChunkBlocks - 1) / SyncChunkBlocks;
+        if (m_syncBuffers.size() < chunks)
+            m_syncBuffers.resize(chunks);
+
+        if (m_transforms.ConsumeHierarchyChanged())
+            m_hierarchyDirty = true;
+        if (m_hierarchyDirty)
+            rebuildHierarchy();
+
+        // 1) TRS -> matrizes locais, matrizes de mundo e bounds das raízes, 8 transforms por vez
+        auto composeChunks = [&](size_t first, size_t last) {
+            for (size_t chunk = first; chunk < last; ++chunk) {
+                const size_t begin = chunk * SyncChunkBlocks;
+                m_transforms.ComposeBlocks(begin, std::min(begin + SyncChunkBlocks, blocks), m_syncBuffers[chunk]);
+            }
+        };
+
+        if (m_threadPool && chunks >= 2)
+            ParallelForRange(*m_threadPool, size_t(0), chunks, size_t(1), composeChunks);
+        else
+            composeChunks(0, chunks);
+
+        // 2) filhos: mundo = mundo do pai * local e bounds a partir dela, nível por nível
+        propagateHierarchy();
+        m_transforms.ClearDirty();
+
+        // a árvore em si não é thread-safe, então o UpdateMany é serial
+        m_syncIds.clear();
+        m_syncBounds.clear();
+        auto gather = [this](std::vector<TransformStore::BoundsChange>& buffer) {
+            for (const TransformStore::BoundsChange& change : buffer) {
+                m_syncIds.push_back(change.id);
+                m_syncBounds.emplace_back(change.oldBounds, change.newBounds);
+            }
+            buffer.clear();
+        };
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+            gather(m_syncBuffers[chunk]);
+        for (auto& buffer : m_hierarchyBuffers) // raízes e filhos são slots distintos: sem id repetido
+            gather(buffer);
+
+        if (!m_syncIds.empty())
+            m_worldSpace.UpdateMany(m_syncBounds, m_syncIds);
+        return m_syncIds.size();
+    }
+
+    void World::propagateHierarchy() {
+        if (m_hierarchy.empty()) return;
+
+        ++m_syncFrame;
+        if (m_worldStamp.size() < m_transforms.GetSlotCount())
+            m_worldStamp.resize(m_transforms.GetSlotCount(), 0);
+
+        // bounds dos filhos: um buffer por faixa de HierarchyChunk nós de m_hierarchy
+        const size_t chunks = (m_hierarchy.size() + HierarchyChunk - 1) / HierarchyChunk;
+        if (m_hierarchyBuffers.size() < chunks)
+            m_hierarchyBuffers.resize(chunks);
+
+        // um nível por vez (os filhos leem a matriz do pai); dentro do nível, faixas em paralelo.
+        // Uma faixa na divisa de dois níveis é visitada pelos dois, mas um depois do outro.
+        for (size_t level = 0; level + 1 < m_levelOffsets.size(); ++level) {
+            const size_t begin = m_levelOffsets[level];
+            const size_t end = m_levelOffsets[level + 1];
+            if (begin == end) continue;
+
+            auto levelChunks = [&](size_t first, size_t last) {
+                for (size_t chunk = first; chunk < last; ++chunk) {
+                    const size_t from = std::max(begin, chunk * HierarchyChunk);
+                    const size_t to = std::min(end, (chunk + 1) * HierarchyChunk);
+                    for (size_t i = from; i < to; ++i) {
+                        const HierarchyNode& node = m_hierarchy[i];
+
+                        // só se o próprio TRS mudou ou se o pai foi recalculado neste sync
+                        if (m_transforms.IsDirty(node.slot) || m_transforms.IsDirty(node.parent) || m_worldStamp[node.parent] == m_syncFrame) {
+                            m_transforms.ComposeWorld(node.slot, node.parent, m_hierarchyBuffers[chunk]);
+                            m_worldStamp[node.slot] = m_syncFrame;
+                        }
+                    }
+                }
+            };
+
+            const size_t firstChunk = begin / HierarchyChunk;
+            const size_t lastChunk = (end - 1) / HierarchyChunk + 1;
+            if (m_threadPool && end - begin >= 2 * HierarchyChunk)
+                ParallelForRange(*m_threadPool, firstChunk, lastChunk, size_t(1), levelChunks);
+            else
+                levelChunks(firstChunk, lastChunk);
+        }
+    }
+
+    void World::rebuildHierarchy() {
+        auto& storage = m_registry.storage<TransformComponent>();
+        const size_t count = storage.size();
+        const entt::entity* entities = storage.data();
+        const uint32_t slotCount = static_cast<uint32_t>(m_transforms.GetSlotCount());
+
+        constexpr uint32_t Unknown = UINT32_MAX;
+        constexpr uint32_t Visiting = UINT32_MAX - 1;
+
+        // slot do pai de cada slot; pai destruído (contains compara a versão) ou sem transform conta como raiz
+        std::vector<uint32_t> parentOf(slotCount, NoParent);
+        for (size_t i = 0; i < count; ++i) {
+            const TransformComponent& tc = storage.get(entities[i]);
+            if (tc.m_parent == entt::null || tc.m_parent == entities[i] || !storage.contains(tc.m_parent)) continue;
+
+            const TransformComponent& parent = storage.get(tc.m_parent);
+            if (parent.m_store == &m_transforms && m_transforms.IsLive(parent.m_slot))
+                parentOf[tc.m_slot] = parent.m_slot;
+        }
+
+        // profundidade: sobe até um nó já resolvido e preenche o caminho na volta
+        std::vector<uint32_t> depth(slotCount, Unknown);
+        std::vector<uint32_t> chain;
+        uint32_t maxDepth = 0;
+        for (uint32_t i = 0; i < slotCount; ++i) {
+            chain.clear();
+            uint32_t n = i;
+            while (depth[n] == Unknown) {
+                depth[n] = Visiting;
+                chain.push_back(n);
+                if (parentOf[n] == NoParent) break;
+                n = parentOf[n];
+            }
+
+            if (depth[n] == Visiting && parentOf[chain.back()] != NoParent) {
+                CP_LOG_WARN("[World] Transform hierarchy cycle at entity {}; treating it as a root", m_transforms.GetEntity(chain.back()));
+                parentOf[chain.back()] = NoParent;
+            }
+
+            for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+                depth[*it] = parentOf[*it] == NoParent ? 0 : depth[parentOf[*it]] + 1;
+                maxDepth = std::max(maxDepth, depth[*it]);
+            }
+        }
+
+        // quem mudou de pai (ou virou raiz) recalcula; raízes pegam a matriz de mundo do kernel
+        m_parentSlots.resize(slotCount, NoParent);
+        for (uint32_t slot = 0; slot < slotCount; ++slot) {
+            if (!m_transforms.IsLive(slot)) continue;
+            if (parentOf[slot] != m_parentSlots[slot])
+                m_transforms.MarkDirty(slot);
+            m_transforms.SetRoot(slot, parentOf[slot] == NoParent);
+        }
+        m_parentSlots = parentOf;
+
+        // counting sort por profundidade (só quem tem pai): pais sempre antes dos filhos
+        m_levelOffsets.assign(size_t(maxDepth) + 1, 0);
+        for (uint32_t d : depth)
+            if (d > 0) ++m_levelOffsets[d];
+        for (size_t level = 1; level < m_levelOffsets.size(); ++level)
+            m_levelOffsets[level] += m_levelOffsets[level - 1];
+
+        std::vector<size_t> cursor(m_levelOffsets.begin(), m_levelOffsets.end() - 1);
+        m_hierarchy.resize(m_levelOffsets.back());
+        for (uint32_t slot = 0; slot < slotCount; ++slot) {
+            if (depth[slot] == 0) continue;
+            m_hierarchy[cursor[depth[slot] - 1]++] = { slot, parentOf[slot] };
+        }
+
+        m_hierarchyDirty = false;
+    }
+
     void World::setupCallbacks() {
         m_registry.on_construct<TransformComponent>().connect<&World::onTransformAddCallback>(this);
         m_registry.on_destroy<TransformComponent>().connect<&World::onTransformRemovedCallback>(this);
@@ -27,18 +198,22 @@ namespace cp_api {
 
     void World::onTransformAddCallback(entt::registry& reg, entt::entity e) {
         TransformComponent& tc = reg.get<TransformComponent>(e);
-        tc.m_entityID = (uint32_t)e;
-
-        tc.onTransformEvents.Subscribe<onTransformChanged>([&](const onTransformChanged& event) {
-            m_worldSpace.Update(event.id, event.oldBoundary, event.newBoundary);
-        });
+        const TransformComponent::Pending& pending = tc.m_pending;
 
-        physics3D::AABB b(tc.position - tc.boundary.Min(), tc.position + tc.boundary.Max());
-        m_worldSpace.Insert((uint32_t)e, b, nullptr);
+        tc.m_slot = m_transforms.Allocate((uint32_t)e, pending.position, pending.rotation, pending.scale, pending.localBounds);
+        tc.m_store = &m_transforms;
+        m_worldSpace.Insert((uint32_t)e, m_transforms.GetWorldBounds(tc.m_slot), nullptr);
+        // mesmo sem pai: a entidade pode ser pai de filhos que já a referenciam, e o slot reciclado
+        // pode estar na hierarquia achatada de antes
+        m_hierarchyDirty = true;
     }
 
     void World::onTransformRemovedCallback(entt::registry& reg, entt::entity e) {
         TransformComponent& tc = reg.get<TransformComponent>(e);
-        m_worldSpace.Remove((uint32_t)e, tc.boundary);
+        m_worldSpace.Remove((uint32_t)e, m_transforms.GetWorldBounds(tc.m_slot));
+        m_transforms.Release(tc.m_slot);
+        tc.m_store = nullptr;
+        tc.m_slot = TransformStore::InvalidSlot;
+        m_hierarchyDirty = true;
     }
 } // namespace cp_api